@@ -0,0 +1,406 @@
+/*==============================================================================
+   RainBench – offline timing of the grain renderer, no host or audio device
+
+   RainBench kernel [int16]
+       Every render kernel the CPU supports (per ISA, interpolator and
+       channel layout) on the same random grains: ns per output frame,
+       the concurrent grains one core sustains at 48 kHz, and the largest
+       deviation from the scalar reference (0 = bit-identical).
+
+   RainBench scaling [maxHelpers]
+       The whole GrainEngine under a dense 8-note chord, rendered with 0, 1,
+       … maxHelpers render helper threads (default: one per spare core):
+       ms of CPU time per second of audio, and speedup over the audio
+       thread alone. Helpers the OS refuses real-time priority are not
+       started, so the helpers column shows what actually ran.
+
+   RainBench wide [minutes] [unordered|ordered]
+       The same chord reading a long stereo file across its whole width,
+       with the "sourceOrdering" setting off and on. The file takes 22 MB
+       per minute; the default 5 minutes outgrows a desktop LLC, a server
+       part may need more. Name one of the two to run it alone, e.g. under
+           perf stat -e LLC-loads,LLC-load-misses RainBench wide 5 ordered
+
+   Build with the Release configuration; Debug numbers mean nothing.
+==============================================================================*/
+#include <JuceHeader.h>
+#include "../../Source/DSP/GrainRenderKernel.h"
+#include "../../Source/DSP/CompactBuffer.h"
+#include "../../Source/DSP/GrainEngine.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+using namespace grain::kernel;
+using Clock = std::chrono::steady_clock;
+
+constexpr double kRate = 48000.0;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+const char* interpName(Interp interp)
+{
+    switch (interp)
+    {
+    case Interp::Hermite: return "hermite";
+    case Interp::Sinc:    return "sinc";
+    default:              return "linear";
+    }
+}
+
+const char* layoutName(Layout layout)
+{
+    switch (layout)
+    {
+    case Layout::MonoToStereo: return "mono>stereo";
+    case Layout::Stereo:       return "stereo";
+    default:                   return "mono";
+    }
+}
+
+/* The scalar reference first, then whatever this CPU runs natively */
+std::vector<Isa> availableIsas()
+{
+    std::vector<Isa> isas{ Isa::Scalar };
+    const Isa best = detectIsa();
+#if RAIN_KERNEL_X86
+    if (best != Isa::Scalar)
+        isas.push_back(Isa::SSE2);
+    if (best == Isa::AVX2)
+        isas.push_back(Isa::AVX2);
+#elif RAIN_KERNEL_NEON
+    if (best == Isa::NEON)
+        isas.push_back(Isa::NEON);
+#endif
+    return isas;
+}
+
+//==============================================================================
+// kernel – grain::kernel alone, one grain at a time into a 2-channel bus
+
+struct KernelGrain
+{
+    uint64_t readPos, step;     // 32.32 fixed
+    float    gain[2];
+};
+
+constexpr int kGrainFrames = 512;
+constexpr int kNumGrains = 4096;
+
+template <typename T>
+void renderAll(RenderFnT<T> fn, const T* const* src, const std::vector<KernelGrain>& grains,
+               const float* env, float* const* bus)
+{
+    for (const auto& g : grains)
+        fn(src, g.readPos, g.step, env, g.gain, bus, kGrainFrames);
+}
+
+template <typename T>
+int runKernel(const T* const* src, int numSrcFrames, const char* sampleType)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // ±1 octave, read heads kept clear of both ends for the widest interpolator
+    std::vector<KernelGrain> grains(kNumGrains);
+    const double lastStart = numSrcFrames - kGrainFrames * 2.0 - 2 * kMaxSupport.after;
+    for (auto& g : grains)
+    {
+        const double ratio = std::pow(2.0, unit(rng) * 2.0 - 1.0);
+        g.step = static_cast<uint64_t>(ratio * 4294967296.0);
+        g.readPos = static_cast<uint64_t>((kMaxSupport.before + unit(rng) * lastStart) * 4294967296.0);
+        g.gain[0] = static_cast<float>(unit(rng));
+        g.gain[1] = 1.0f - g.gain[0];
+    }
+
+    std::vector<float> env(kGrainFrames);
+    for (int s = 0; s < kGrainFrames; ++s)
+        env[static_cast<std::size_t>(s)] = static_cast<float>(std::sin(3.14159265358979 * (s + 0.5) / kGrainFrames));
+
+    std::vector<float> busData(2 * kGrainFrames), refData(2 * kGrainFrames);
+    float* bus[2] = { busData.data(), busData.data() + kGrainFrames };
+
+    std::printf("kernel: %d grains x %d frames, %s source, 1 core\n\n", kNumGrains, kGrainFrames, sampleType);
+    std::printf("%-7s %-8s %-12s %9s %12s %12s\n", "isa", "interp", "layout", "ns/frame", "grains/core", "max |err|");
+
+    for (int l = 0; l < static_cast<int>(Layout::Count); ++l)
+        for (int i = 0; i < static_cast<int>(Interp::Count); ++i)
+        {
+            const auto layout = static_cast<Layout>(l);
+            const auto interp = static_cast<Interp>(i);
+            const auto pick = [&](Isa isa)
+                {
+                    const Kernel k = getKernel(isa, interp, layout);
+                    if constexpr (std::is_same_v<T, int16_t>) return k.enveloped16;
+                    else                                       return k.enveloped;
+                };
+
+            const auto reference = pick(Isa::Scalar);
+            std::fill(busData.begin(), busData.end(), 0.0f);
+            renderAll(reference, src, grains, env.data(), bus);
+            refData = busData;
+
+            for (const Isa isa : availableIsas())
+            {
+                const auto fn = pick(isa);
+                if (isa != Isa::Scalar && fn == reference)
+                    continue;                           // runs the scalar loop (SSE2 sinc)
+
+                std::fill(busData.begin(), busData.end(), 0.0f);
+                renderAll(fn, src, grains, env.data(), bus);
+                float maxErr = 0.0f;
+                for (std::size_t s = 0; s < busData.size(); ++s)
+                    maxErr = std::max(maxErr, std::abs(busData[s] - refData[s]));
+
+                // best of 5 passes of at least 50 ms each
+                double best = 1e30;
+                for (int pass = 0; pass < 5; ++pass)
+                {
+                    int reps = 0;
+                    const auto start = Clock::now();
+                    double elapsed = 0.0;
+                    do
+                    {
+                        renderAll(fn, src, grains, env.data(), bus);
+                        ++reps;
+                    } while ((elapsed = secondsSince(start)) < 0.05);
+                    best = std::min(best, elapsed / reps);
+                }
+
+                const double nsPerFrame = best * 1e9 / (double(kNumGrains) * kGrainFrames);
+                std::printf("%-7s %-8s %-12s %9.2f %12.0f %12.3g\n", getIsaName(isa), interpName(interp),
+                            layoutName(layout), nsPerFrame, 1e9 / (nsPerFrame * kRate), double(maxErr));
+            }
+        }
+
+    std::printf("\ngrains/core: grains of any length one core renders in real time at 48 kHz\n");
+    return 0;
+}
+
+int kernelBench(bool int16)
+{
+    // 4 s of noise: bigger than L2, small enough that timing is the kernel's
+    constexpr int numFrames = static_cast<int>(4 * kRate);
+    juce::AudioBuffer<float> source(2, numFrames);
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        float* dst = source.getWritePointer(ch);
+        for (int s = 0; s < numFrames; ++s)
+            dst[s] = noise(rng);
+    }
+
+    if (int16)
+    {
+        const CompactBuffer compact(source);
+        const int16_t* src[2] = { compact.getReadPointer(0), compact.getReadPointer(1) };
+        return runKernel<int16_t>(src, numFrames, "int16");
+    }
+
+    const float* src[2] = { source.getReadPointer(0), source.getReadPointer(1) };
+    return runKernel<float>(src, numFrames, "float");
+}
+
+//==============================================================================
+// engine – GrainEngine end to end, as the plugin runs it
+
+constexpr int kBlockSize = 512;
+
+/* Parameter values the engine reads, at the plugin's defaults */
+struct BenchParams
+{
+    std::array<std::atomic<float>, static_cast<std::size_t>(ParamID::ID::Count)> values;
+    ParameterBank bank;
+
+    BenchParams()
+    {
+        using ParamID::ID;
+        const std::pair<ID, float> defaults[] = {
+            { ID::playMode, 0.0f },            { ID::grainRate, 50.0f },
+            { ID::delayRandomRange, 0.0f },    { ID::midiRootNote, 60.0f },
+            { ID::grainPitchMin, 0.0f },       { ID::grainPitchMax, 0.0f },
+            { ID::grainVolumeMin, 0.0f },      { ID::grainVolumeMax, 0.0f },
+            { ID::grainPanMin, 0.0f },         { ID::grainPanMax, 0.0f },
+            { ID::grainPositionMin, 0.0f },    { ID::grainPositionMax, 0.0f },
+            { ID::grainEnvAttack, 45.0f },     { ID::grainEnvSustainLength, 0.1f },
+            { ID::grainEnvRelease, 45.0f },    { ID::grainEnvAttackCurve, 2.0f },
+            { ID::grainEnvReleaseCurve, 3.0f },{ ID::grainEnvShape, 0.0f },
+            { ID::grainInterpolation, 0.0f },  { ID::voiceAttack, 1.0f },
+            { ID::voiceDecay, 2.0f },          { ID::voiceSustain, 0.5f },
+            { ID::voiceRelease, 1.0f },        { ID::voiceAttackPower, 2.0f },
+            { ID::voiceDecayPower, 3.0f },     { ID::voiceReleasePower, 4.0f },
+        };
+        static_assert(std::size(defaults) == static_cast<std::size_t>(ID::Count));
+
+        for (const auto& [id, value] : defaults)
+            set(id, value);
+        for (std::size_t i = 0; i < values.size(); ++i)
+            bank.ptrs[i] = &values[i];
+    }
+
+    void set(ParamID::ID id, float value) { values[ParamID::idx(id)].store(value); }
+};
+
+/* ~1000 overlapping grains: 8 voices × 1 kHz × 120 ms, ±1 octave, spread
+   across the whole file, voices at full level after 1 ms */
+void setDenseChord(BenchParams& params)
+{
+    using ParamID::ID;
+    params.set(ID::grainRate, 1000.0f);
+    params.set(ID::grainPitchMin, -12.0f);
+    params.set(ID::grainPitchMax, 12.0f);
+    params.set(ID::grainPanMin, -1.0f);
+    params.set(ID::grainPanMax, 1.0f);
+    params.set(ID::grainPositionMax, 100.0f);
+    params.set(ID::grainEnvSustainLength, 30.0f);
+    params.set(ID::voiceAttack, 0.001f);
+    params.set(ID::voiceSustain, 1.0f);
+}
+
+LoadedSample makeNoiseSample(double seconds)
+{
+    LoadedSample sample;
+    sample.sampleRate = kRate;
+    sample.buffer = std::make_shared<juce::AudioBuffer<float>>(2, static_cast<int>(seconds * kRate));
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        float* dst = sample.buffer->getWritePointer(ch);
+        for (int s = 0; s < sample.buffer->getNumSamples(); ++s)
+            dst[s] = noise(rng);
+    }
+    return sample;
+}
+
+struct EngineResult
+{
+    int    helpers = 0;          // render helpers that actually ran
+    double msPerSecond = 0.0;    // wall time per second of audio
+};
+
+/* Holds an 8-note chord for a 1 s warm-up plus `seconds` timed */
+EngineResult renderChord(const BenchParams& params, const LoadedSample& sample,
+                         int numHelpers, bool sourceOrdering, double seconds)
+{
+    auto engine = std::make_unique<GrainEngine>();
+    engine->setParameterBank(&params.bank);
+    engine->setRandomSeed(1);
+    engine->setRenderThreads(numHelpers);
+    engine->setSourceOrdering(sourceOrdering);
+    engine->prepare(kRate, kBlockSize);
+    engine->setLoadedSample(sample);
+
+    juce::AudioBuffer<float> output(2, kBlockSize);
+    juce::MidiBuffer chord, none;
+    for (int note = 0; note < 8; ++note)
+        chord.addEvent(juce::MidiMessage::noteOn(1, 48 + note * 3, 1.0f), 0);
+
+    const int warmupBlocks = static_cast<int>(kRate) / kBlockSize;
+    const int timedBlocks = static_cast<int>(seconds * kRate) / kBlockSize;
+
+    engine->process(output, chord);
+    for (int b = 1; b < warmupBlocks; ++b)
+        engine->process(output, none);
+
+    const auto start = Clock::now();
+    for (int b = 0; b < timedBlocks; ++b)
+        engine->process(output, none);
+    const double elapsed = secondsSince(start);
+
+    return { engine->getNumRenderHelpers(),
+             elapsed * 1000.0 / (double(timedBlocks) * kBlockSize / kRate) };
+}
+
+int scalingBench(int maxHelpers)
+{
+    BenchParams params;
+    setDenseChord(params);
+    const LoadedSample sample = makeNoiseSample(20.0);
+
+    std::printf("scaling: 8 voices, ~1000 grains, 20 s stereo source, %u hardware threads\n\n",
+                std::thread::hardware_concurrency());
+    std::printf("%8s %8s %14s %9s\n", "asked", "helpers", "ms/s audio", "speedup");
+
+    double serial = 0.0;
+    for (int asked = 0; asked <= maxHelpers; ++asked)
+    {
+        const EngineResult r = renderChord(params, sample, asked, false, 10.0);
+        if (asked == 0)
+            serial = r.msPerSecond;
+
+        std::printf("%8d %8d %14.1f %8.2fx\n", asked, r.helpers, r.msPerSecond, serial / r.msPerSecond);
+        if (r.helpers < asked)
+            break;                              // capped by the core count or refused real-time
+    }
+    return 0;
+}
+
+int wideBench(double minutes, const char* only)
+{
+    BenchParams params;
+    setDenseChord(params);
+    const LoadedSample sample = makeNoiseSample(minutes * 60.0);
+
+    std::printf("wide: 8 voices, ~1000 grains over all of a %.0f min stereo source (%.0f MB), 1 thread\n\n",
+                minutes, sample.buffer->getNumSamples() * 2.0 * sizeof(float) / (1024.0 * 1024.0));
+    std::printf("%-10s %14s\n", "grains", "ms/s audio");
+
+    for (const bool ordered : { false, true })
+    {
+        const char* name = ordered ? "ordered" : "unordered";
+        if (only != nullptr && std::strcmp(only, name) != 0)
+            continue;
+
+        const EngineResult r = renderChord(params, sample, 0, ordered, 10.0);
+        std::printf("%-10s %14.1f\n", name, r.msPerSecond);
+    }
+    return 0;
+}
+
+int usage()
+{
+    std::printf("usage: RainBench kernel [int16]\n"
+                "       RainBench scaling [maxHelpers]\n"
+                "       RainBench wide [minutes] [unordered|ordered]\n");
+    return 1;
+}
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+        return usage();
+
+    if (std::strcmp(argv[1], "kernel") == 0)
+        return kernelBench(argc > 2 && std::strcmp(argv[2], "int16") == 0);
+
+    if (std::strcmp(argv[1], "scaling") == 0)
+    {
+        const int spareCores = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+        return scalingBench(argc > 2 ? std::max(0, std::atoi(argv[2])) : spareCores);
+    }
+
+    if (std::strcmp(argv[1], "wide") == 0)
+        return wideBench(argc > 2 ? std::clamp(std::atof(argv[2]), 1.0, 60.0) : 5.0, argc > 3 ? argv[3] : nullptr);
+
+    return usage();
+}
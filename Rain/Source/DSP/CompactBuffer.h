@@ -0,0 +1,68 @@
+/*==============================================================================
+   CompactBuffer.h  – int16 copy of an audio buffer plus one scale factor
+
+   Half the memory and read bandwidth of float storage: grains widen the
+   int16 frames to float in registers and fold the scale into their gain.
+   The scale maps the buffer's peak to full range, so quiet material keeps
+   all 16 bits (about -96 dB below its own peak).
+
+   kPad zero frames sit on both sides of every channel: interpolators may
+   read a few frames past either end, and the AVX2 kernel's 32-bit gathers
+   read one int16 past the frame they want.
+==============================================================================*/
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class CompactBuffer
+{
+public:
+    static constexpr int kPad = 4;                  // ≥ widest interpolator support
+
+    CompactBuffer() = default;
+
+    explicit CompactBuffer(const juce::AudioBuffer<float>& source)
+        : numChannels(source.getNumChannels()),
+          numFrames(source.getNumSamples()),
+          stride(source.getNumSamples() + 2 * kPad)
+    {
+        float peak = 0.0f;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* src = source.getReadPointer(ch);
+            for (int i = 0; i < numFrames; ++i)
+                peak = std::max(peak, std::abs(src[i]));
+        }
+
+        scale = peak > 0.0f ? peak / 32767.0f : 1.0f;
+        const float toInt = 1.0f / scale;
+
+        data.assign(static_cast<std::size_t>(numChannels) * static_cast<std::size_t>(stride), 0);
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* src = source.getReadPointer(ch);
+            int16_t*     dst = data.data() + static_cast<std::size_t>(ch) * stride + kPad;
+            for (int i = 0; i < numFrames; ++i)
+                dst[i] = static_cast<int16_t>(std::lrint(std::clamp(src[i] * toInt, -32767.0f, 32767.0f)));
+        }
+    }
+
+    int   getNumChannels() const noexcept { return numChannels; }
+    int   getNumSamples() const noexcept  { return numFrames; }
+    float getScale() const noexcept       { return scale; }     // float value = int16 · scale
+
+    const int16_t* getReadPointer(int channel) const noexcept
+    {
+        return data.data() + static_cast<std::size_t>(channel) * stride + kPad;
+    }
+
+    std::size_t getSizeInBytes() const noexcept { return data.size() * sizeof(int16_t); }
+
+private:
+    std::vector<int16_t> data;                      // channels back to back, kPad each side
+    int   numChannels = 0, numFrames = 0, stride = 0;
+    float scale = 1.0f;
+};
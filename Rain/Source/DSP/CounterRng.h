@@ -0,0 +1,71 @@
+/*==============================================================================
+   CounterRng.h  – counter-based random numbers (Squares, Widynski 2020)
+
+   Value i of a stream is a pure function of (i, key). There is no state
+   carried from one value to the next, so a batch is one loop of independent
+   lanes that the compiler can vectorise. A seed gives the same stream on
+   every run and platform: renders with a fixed seed are reproducible.
+==============================================================================*/
+#pragma once
+#include <cstdint>
+
+namespace grain::rng
+{
+    /* Four rounds of squaring with a half swap; 32 good bits per call */
+    inline uint32_t squares32(uint64_t counter, uint64_t key) noexcept
+    {
+        uint64_t x = counter * key;
+        const uint64_t y = x, z = y + key;
+
+        x = x * x + y; x = (x >> 32) | (x << 32);
+        x = x * x + z; x = (x >> 32) | (x << 32);
+        x = x * x + y; x = (x >> 32) | (x << 32);
+        return static_cast<uint32_t>((x * x + z) >> 32);
+    }
+
+    /* Top 24 bits → [0, 1), exact in float */
+    inline float toUnit(uint32_t bits) noexcept
+    {
+        return float(bits >> 8) * (1.0f / 16777216.0f);
+    }
+
+    /* Squares wants a key with well-mixed bits: splitmix64 of the seed, odd */
+    inline uint64_t keyFromSeed(uint64_t seed) noexcept
+    {
+        uint64_t z = seed + 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return (z ^ (z >> 31)) | 1u;
+    }
+
+    class CounterRng
+    {
+    public:
+        void seed(uint64_t seedValue) noexcept
+        {
+            key = keyFromSeed(seedValue);
+            counter = 0;
+        }
+
+        /* The next n values of the stream, in [0, 1) */
+        void fill(float* out, int n) noexcept
+        {
+            const uint64_t base = counter;
+            for (int i = 0; i < n; ++i)
+                out[i] = toUnit(squares32(base + static_cast<uint64_t>(i), key));
+            counter = base + static_cast<uint64_t>(n);
+        }
+
+        /* One value at a time, for draws that depend on the previous one */
+        float next() noexcept
+        {
+            return toUnit(squares32(counter++, key));
+        }
+
+        uint64_t getCounter() const noexcept { return counter; }
+
+    private:
+        uint64_t key = keyFromSeed(0);
+        uint64_t counter = 0;
+    };
+}
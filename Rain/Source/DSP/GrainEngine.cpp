@@ -7,6 +7,12 @@ GrainEngine::GrainEngine()
 	// Initialize the grain pool and voice pool
 	pool.clear();
 	voices.clear();
+
+	// Build the shared envelope / interpolation / pan tables here, never on the audio thread
+	grain::window::getTables();
+	grain::kernel::getSincTable();
+	grain::ratio::getTables();
+	grain::pan::getTables();
 };
 
 void GrainEngine::setParameterBank(const ParameterBank* bank) noexcept
@@ -20,33 +26,108 @@ void GrainEngine::prepare(double sr, int blockSize)
 {
     sampleRate = sr;
     maxBlockSize = blockSize;
+    subBlockSize = std::clamp(blockSize, 1, kSubBlockFrames);
+
+    // Pool and editor data are resized here, off the audio thread
+    if (pool.getCapacity() != grainCapacity)
+        pool.allocate(grainCapacity);
+    visualData.allocate(pool.getCapacity());
+    processor.setGrainCapacity(pool.getCapacity());
 
-    spawner.prepare(sr, blockSize);
-    processor.prepare(sr, blockSize);
+    // Both stages only ever see sub-blocks, whatever the host sends
+    spawner.prepare(sr, subBlockSize, pool.getCapacity());
+    processor.prepare(sr, subBlockSize);
     pool.clear();
     visualData.clear();
+    DBG("GrainEngine: " << static_cast<int>(pool.getCapacity()) << " grain slots, "
+        << static_cast<int>(pool.getSizeInBytes() / 1024) << " kB");
 }
 
 void GrainEngine::reset()
 {
+    spawner.prepare(sampleRate, subBlockSize, pool.getCapacity());           // also restarts the random stream
     pool.clear();
     visualData.clear();
 }
 
 void GrainEngine::process(juce::AudioBuffer<float>& output, const juce::MidiBuffer& midi)
 {
-	if (processor.getSample().buffer == nullptr)
+	// A newly published sample takes over here, never inside a block
+	processor.pickUpSampleSource(pool);
+	spawner.setSample(&processor.getSample());
+
+	if (!processor.getSample().hasAudio())
 	{
 		output.clear();
 		return; // No sample loaded
 	}
 
-	spawner.processMidi(midi, pool);
-    processor.process(pool, voices, output);
+	const int quality = static_cast<int>(params->get(ParamID::ID::grainInterpolation));
+	processor.setInterpolation(static_cast<grain::kernel::Interp>(
+		std::clamp(quality, 0, static_cast<int>(grain::kernel::Interp::Count) - 1)));
+
+	// Host blocks of any size run as fixed sub-blocks: buses, envelope
+	// ramps and scratch stay subBlockSize long and in cache, and nothing is
+	// resized on the audio thread. A zero-length block still runs its MIDI.
+	const int numFrames = output.getNumSamples();
+	spawner.beginBlock(numFrames);
+
+	int start = 0;
+	do
+	{
+		const int n = std::min(subBlockSize, numFrames - start);
+		juce::AudioBuffer<float> chunk(output.getArrayOfWritePointers(), output.getNumChannels(), start, n);
+
+		spawner.processMidi(midi, pool, start, n);
+		processor.process(pool, voices, chunk);
+		start += n;
+	} while (start < numFrames);
+
+    // Editor only needs to scan the slots that can still hold a live grain
+    visualData.slotHighWater.store(pool.slotHighWater(), std::memory_order_release);
+}
+
+void GrainEngine::setRenderThreads(int numHelpers)
+{
+    processor.setRenderThreads(numHelpers);
+}
+
+void GrainEngine::setSourceOrdering(bool shouldOrder)
+{
+    processor.setSourceOrdering(shouldOrder);
+}
+
+void GrainEngine::setGrainCapacity(int numGrains)
+{
+    grainCapacity = GrainPool::tierFor(static_cast<std::size_t>(std::max(numGrains, 1)));
+}
+
+void GrainEngine::setSpawnMode(grain::schedule::Mode mode)
+{
+    spawner.setSpawnMode(mode);
+}
+
+void GrainEngine::setRandomSeed(uint64_t seed)
+{
+    spawner.setRandomSeed(seed);
+}
+
+void GrainEngine::setSilenceThreshold(float decibels)
+{
+    processor.setSilenceThreshold(grain::ratio::fromDecibels(decibels));
+}
+
+void GrainEngine::setOverflowPolicy(OverflowPolicy policy)
+{
+    spawner.setOverflowPolicy(policy);
 }
 
 void GrainEngine::setLoadedSample(const LoadedSample& sample)
 {
-	processor.setSampleSource(sample); // Source is stored in the proccesor for quick acces
-    spawner.setSample(&processor.getSample());  
+	processor.setSampleSource(sample); // picked up by the audio thread at its next block
+}
+
+void GrainEngine::releaseRetiredSamples()
+{
+    processor.releaseRetiredSamples();
 }
@@ -4,6 +4,8 @@
 #include "VoicePool.h"
 #include "GrainSpawner.h"
 #include "GrainProcessor.h"
+#include "GrainWindow.h"
+#include "RatioTable.h"
 #include "../Parameters/ParameterBank.h"
 #include "../Extras/LoadedSample.h"
 
@@ -20,15 +22,30 @@ public:
     void reset();
     void process(juce::AudioBuffer<float>& output, const juce::MidiBuffer& midi);
 
-    void setLoadedSample(const LoadedSample& sample);
+    void setLoadedSample(const LoadedSample& sample);  // any thread but audio; crossfades in at a block start
+    void releaseRetiredSamples();                      // frees samples the audio thread let go; not audio thread
+    void setRenderThreads(int numHelpers);             // 0 = audio thread only
+    int  getNumRenderHelpers() const noexcept { return processor.getNumRenderHelpers(); } // those actually running
+    void setSourceOrdering(bool shouldOrder);          // sort grains by source position
+    void setOverflowPolicy(OverflowPolicy policy);     // full pool: drop or steal
+    void setGrainCapacity(int numGrains);              // rounded up to a pool tier at prepare
+    void setSpawnMode(grain::schedule::Mode mode);     // periodic or Poisson onsets
+    void setRandomSeed(uint64_t seed);                 // 0 = per instance; restarts at prepare / reset
+    void setSilenceThreshold(float decibels);          // quieter grains are not rendered; <= -100 dB = off
     GrainVisualData& getGrainVisualData() noexcept { return visualData; }
 
 private:
 
     const ParameterBank* params = nullptr;
 
+    // Sub-block length: small enough that a voice bus, its gain ramp and
+    // the envelope scratch of one sub-block stay in L1
+    static constexpr int kSubBlockFrames = 256;
+
     double sampleRate = 44100.0;
     int maxBlockSize = 512;
+    int subBlockSize = kSubBlockFrames;
+    std::size_t grainCapacity = GrainPool::kDefaultCapacity;
 
     GrainPool pool;
 	VoicePool voices;
@@ -0,0 +1,111 @@
+#pragma once
+#include "GrainPool.h"
+#include "GrainWindow.h"
+#include <algorithm>
+
+namespace grain::env
+{
+    /*--------------------------------------------------------------------
+        setStage – enter a stage, skipping any that are zero frames long
+        Attack  : envAttackFrames                      (ramp 0 → 1)
+        Sustain : length - attack - release            (flat 1)
+        Release : envReleaseFrames                     (ramp 1 → 0)
+    --------------------------------------------------------------------*/
+    inline void setStage(GrainPool& pool, std::size_t g, GrainStage st) noexcept
+    {
+        for (;;)
+        {
+            pool.envStage[g] = st;
+
+            switch (st)
+            {
+            case GrainStage::Attack:
+                pool.envStageLeft[g] = pool.envAttackFrames[g];
+                break;
+            case GrainStage::Sustain:
+                pool.envStageLeft[g] = pool.length[g] - pool.envAttackFrames[g] - pool.envReleaseFrames[g];
+                break;
+            case GrainStage::Release:
+                pool.envStageLeft[g] = pool.envReleaseFrames[g];
+                break;
+            default: /* Done */
+                pool.envStageLeft[g] = 0;
+                return;
+            }
+
+            if (pool.envStageLeft[g] > 0)
+                return;
+
+            st = static_cast<GrainStage>(static_cast<uint8_t>(st) + 1);
+        }
+    }
+
+    /* Clamp the ramps into the grain length and enter the first stage */
+    inline void start(GrainPool& pool, std::size_t g) noexcept
+    {
+        const int total = pool.length[g];
+        pool.envAttackFrames[g] = std::clamp(pool.envAttackFrames[g], 0, total);
+        pool.envReleaseFrames[g] = std::clamp(pool.envReleaseFrames[g], 0, total - pool.envAttackFrames[g]);
+        pool.fading[g] = false;
+        pool.oldSource[g] = false;
+
+        setStage(pool, g, GrainStage::Attack);
+    }
+
+    inline void nextStage(GrainPool& pool, std::size_t g) noexcept
+    {
+        setStage(pool, g, static_cast<GrainStage>(static_cast<uint8_t>(pool.envStage[g]) + 1));
+    }
+
+    /* Envelope value the next rendered frame starts from */
+    inline float level(const GrainPool& pool, std::size_t g) noexcept
+    {
+        const auto& windows = grain::window::getTables();
+        const int   left = pool.envStageLeft[g];
+
+        switch (pool.envStage[g])
+        {
+        case GrainStage::Attack:
+        {
+            const int len = pool.envAttackFrames[g];
+            return grain::window::lookup(windows.ramp[pool.envAttackRow[g]], float(len - left) / float(len));
+        }
+        case GrainStage::Sustain:
+            return 1.0f;
+        case GrainStage::Release:
+            return grain::window::lookup(windows.ramp[pool.envReleaseRow[g]],
+                                         float(left) / float(pool.envReleaseFrames[g]));
+        default:
+            return 0.0f;
+        }
+    }
+
+    /* Cut the grain short: a linear fade from its current level to 0 over
+       fadeFrames (at most what it had left), then Done. The level folds
+       into gain so the fade can reuse the release stage. */
+    inline void fadeOut(GrainPool& pool, std::size_t g, int fadeFrames) noexcept
+    {
+        const int n = std::clamp(fadeFrames, 1, std::max(pool.frames[g], 1));
+
+        pool.gain[g] *= level(pool, g);
+        pool.frames[g] = n;
+        pool.envReleaseFrames[g] = n;
+        pool.envReleaseRow[g] = grain::window::kLinearRow;
+        pool.fading[g] = true;
+        setStage(pool, g, GrainStage::Release);
+    }
+
+    /* Advance the stages by n frames without rendering anything */
+    inline void skip(GrainPool& pool, std::size_t g, int n) noexcept
+    {
+        while (n > 0 && pool.envStage[g] != GrainStage::Done)
+        {
+            const int step = std::min(n, pool.envStageLeft[g]);
+            pool.envStageLeft[g] -= step;
+            n -= step;
+
+            if (pool.envStageLeft[g] == 0)
+                nextStage(pool, g);
+        }
+    }
+}
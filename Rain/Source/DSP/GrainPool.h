@@ -1,27 +1,209 @@
 #pragma once
-#include <bitset>
 #include <cstddef>
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <utility>
+#include "SoaBlock.h"
+
+enum class GrainStage : uint8_t { Attack, Sustain, Release, Done };
 
 struct GrainPool
 {
-    static constexpr std::size_t kMaxGrains = 4096;
-
-    std::bitset<kMaxGrains> active;                  // 1 = slot busy
-
-    alignas(64) int     delay[kMaxGrains];        // in samples
-    alignas(64) int     frames[kMaxGrains];        // remaining frames
-    alignas(64) double  samplePos[kMaxGrains];       // readhead
-    alignas(64) float   step[kMaxGrains];
-    alignas(64) float   gain[kMaxGrains];        // 0 … 1
-    alignas(64) float   pan[kMaxGrains];        // –1 … +1
-    alignas(64) int     length[kMaxGrains];
-    alignas(64) int     envAttackFrames[kMaxGrains];
-    alignas(64) int     envReleaseFrames[kMaxGrains];
-    alignas(64) float   envAttackCurve[kMaxGrains];
-    alignas(64) float   envReleaseCurve[kMaxGrains];
-	alignas(64) uint8_t voiceIdx[kMaxGrains]; // which voice/midi note is playing this grain
-
-    void clear() { active.reset(); }
+    /* capacity — picked at prepare time from a few cache-sized tiers ---- */
+    // 256 slots keep the whole pool in L1, 1024 in L2; 16384 is for dense
+    // textures. Every per-grain array below holds `capacity` entries.
+    static constexpr std::array<std::size_t, 4> kCapacityTiers { 256, 1024, 4096, 16384 };
+    static constexpr std::size_t kMaxGrains = kCapacityTiers.back();
+    static constexpr std::size_t kDefaultCapacity = 4096;
+    static constexpr uint16_t    kNoGrain = 0xffff;   // end of a wheel slot list
+    static_assert(kMaxGrains < kNoGrain, "slot indices are stored as uint16_t");
+
+    GrainPool() { allocate(kDefaultCapacity); }
+    GrainPool(const GrainPool&) = delete;             // fields point into storage
+    GrainPool& operator=(const GrainPool&) = delete;
+
+    /* Smallest tier holding `requested` grains (the largest if none does) */
+    static std::size_t tierFor(std::size_t requested) noexcept
+    {
+        for (const std::size_t tier : kCapacityTiers)
+            if (tier >= requested)
+                return tier;
+        return kMaxGrains;
+    }
+
+    /* Resize to the tier for `requested` and clear. Allocates: call from
+       prepare, never while the audio thread is rendering. */
+    void allocate(std::size_t requested)
+    {
+        capacity = tierFor(requested);
+        storage.allocate(capacity,
+                         activeList, activePos, freeList, startAt, wheelNext,
+                         delay, frames, samplePos, step, gain, pan, length,
+                         envAttackFrames, envReleaseFrames, envAttackRow, envReleaseRow,
+                         envStage, envStageLeft, voiceIdx, fading, oldSource);
+        clear();
+    }
+
+    std::size_t getCapacity() const noexcept { return capacity; }
+    std::size_t getSizeInBytes() const noexcept { return sizeof(GrainPool) + storage.getSizeInBytes(); }
+
+    /* slot bookkeeping — O(1) acquire / release ------------------------- */
+    uint16_t* activeList = nullptr;                // dense list of live slots
+    uint16_t* activePos = nullptr;                 // slot → index in activeList
+    uint16_t* freeList = nullptr;                  // stack of free slots (LIFO)
+    int numActive = 0;
+    int numFree = 0;
+
+    /* pending grains — timing wheel of 256-frame ticks ------------------ */
+    // A spawned grain waits here, off the active list, until the block it
+    // starts in. Slot lists are intrusive (wheelNext); a grain further out
+    // than one turn just stays in its slot until its lap comes round.
+    static constexpr int kWheelTickShift = 8;
+    static constexpr int kWheelSlots = 1024;          // one turn: 2^18 frames
+    uint64_t* startAt = nullptr;                      // absolute start frame
+    uint16_t* wheelNext = nullptr;
+    uint16_t wheelHead[kWheelSlots];
+    uint64_t clock = 0;                               // absolute frame of this block's start
+    int      numPending = 0;
+
+    /* per-grain state (SoA, each array cache-line aligned) -------------- */
+    int*        delay = nullptr;             // in samples
+    int*        frames = nullptr;            // remaining frames
+    uint64_t*   samplePos = nullptr;         // readhead, 32.32 fixed (samplePosition::Fixed)
+    uint64_t*   step = nullptr;              // 32.32 fixed
+    float*      gain = nullptr;              // 0 … 1
+    float*      pan = nullptr;               // –1 … +1
+    int*        length = nullptr;
+    int*        envAttackFrames = nullptr;
+    int*        envReleaseFrames = nullptr;
+    uint16_t*   envAttackRow = nullptr;      // grain::window table rows
+    uint16_t*   envReleaseRow = nullptr;
+    GrainStage* envStage = nullptr;          // see grain::env
+    int*        envStageLeft = nullptr;      // frames until the stage ends
+    uint8_t*    voiceIdx = nullptr;          // which voice/midi note is playing this grain
+    bool*       fading = nullptr;            // stolen, running out its anti-click fade
+    bool*       oldSource = nullptr;         // reads the previous sample while it fades out
+
+    bool isActive(std::size_t slot) const noexcept
+    {
+        const int pos = activePos[slot];
+        return pos < numActive && activeList[pos] == slot;
+    }
+
+    /* Pop a free slot for a new grain, -1 when no more than keepFree are
+       left. Hand it to schedule(). */
+    int acquire(int keepFree = 0) noexcept
+    {
+        if (numFree <= keepFree)
+            return -1;
+
+        return freeList[--numFree];
+    }
+
+    /* Start an acquired grain `startDelay` frames after this block's start */
+    void schedule(std::size_t slot, int startDelay) noexcept
+    {
+        startAt[slot] = clock + static_cast<uint64_t>(std::max(startDelay, 0));
+
+        const std::size_t w = (startAt[slot] >> kWheelTickShift) & (kWheelSlots - 1);
+        wheelNext[slot] = wheelHead[w];
+        wheelHead[w] = static_cast<uint16_t>(slot);
+        ++numPending;
+    }
+
+    /* Move pending grains that start within the next numFrames onto the
+       active list; delay[] becomes their offset into the block. Only the
+       wheel slots this block spans are visited. */
+    void activateDue(int numFrames) noexcept
+    {
+        if (numPending == 0 || numFrames <= 0)
+            return;
+
+        const uint64_t end = clock + static_cast<uint64_t>(numFrames);
+        const uint64_t firstTick = clock >> kWheelTickShift;
+        const uint64_t lastTick = std::min((end - 1) >> kWheelTickShift, firstTick + kWheelSlots - 1);
+
+        for (uint64_t t = firstTick; t <= lastTick; ++t)
+        {
+            uint16_t* link = &wheelHead[t & (kWheelSlots - 1)];
+            while (*link != kNoGrain)
+            {
+                const uint16_t slot = *link;
+                if (startAt[slot] >= end)
+                {
+                    link = &wheelNext[slot];                  // a later lap
+                    continue;
+                }
+
+                *link = wheelNext[slot];
+                --numPending;
+
+                delay[slot] = startAt[slot] > clock ? static_cast<int>(startAt[slot] - clock) : 0;
+                activePos[slot] = static_cast<uint16_t>(numActive);
+                activeList[numActive++] = slot;
+            }
+        }
+    }
+
+    /* Free every grain still waiting to start, e.g. when the sample its
+       position was picked in goes away */
+    void dropPending() noexcept
+    {
+        for (uint16_t& head : wheelHead)
+            for (uint16_t slot = std::exchange(head, kNoGrain); slot != kNoGrain; slot = wheelNext[slot])
+                freeList[numFree++] = slot;
+
+        numPending = 0;
+    }
+
+    void advanceClock(int numFrames) noexcept
+    {
+        clock += static_cast<uint64_t>(numFrames);
+    }
+
+    /* Swap-remove from the active list and push back on the free stack.
+       Safe to call while walking activeList backwards. */
+    void release(std::size_t slot) noexcept
+    {
+        if (!isActive(slot))
+            return;
+
+        const int      pos  = activePos[slot];
+        const uint16_t last = activeList[--numActive];
+        activeList[pos] = last;
+        activePos[last] = static_cast<uint16_t>(pos);
+
+        freeList[numFree++] = static_cast<uint16_t>(slot);
+    }
+
+    /* One past the highest live slot – bounds scans over slot-indexed data */
+    int slotHighWater() const noexcept
+    {
+        int hw = 0;
+        for (int i = 0; i < numActive; ++i)
+            hw = activeList[i] >= hw ? activeList[i] + 1 : hw;
+        return hw;
+    }
+
+    void clear()
+    {
+        numActive = 0;
+        numFree = static_cast<int>(capacity);
+        numPending = 0;
+        clock = 0;
+        std::fill(std::begin(wheelHead), std::end(wheelHead), kNoGrain);
+
+        // Lowest slots on top of the stack, so live grains stay packed at
+        // the start of the SoA arrays.
+        for (std::size_t i = 0; i < capacity; ++i)
+        {
+            freeList[i] = static_cast<uint16_t>(capacity - 1 - i);
+            activePos[i] = 0;
+        }
+    }
+
+private:
+    std::size_t capacity = 0;
+    SoaBlock    storage;
 };
@@ -1 +1,40 @@
 #include "GrainProcessor.h"
+
+void GrainProcessor::setRenderThreads(int numHelpers)
+{
+    const int maxHelpers = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    numHelpers = std::clamp(numHelpers, 0, maxHelpers);
+
+    if (numHelpers == workers.getNumHelpers())
+        return;
+
+    if (numHelpers > 0)
+        workers.start(numHelpers);
+    else
+        workers.stop();
+
+    if (busStride > 0)
+        allocateBuses();
+
+    DBG("GrainProcessor: " << workers.getNumHelpers() << " render helper threads");
+}
+
+void GrainProcessor::setGrainCapacity(std::size_t capacity)
+{
+    if (capacity == grainCapacity)
+        return;
+
+    grainCapacity = capacity;
+    if (busStride > 0)
+        allocateBuses();
+}
+
+void GrainProcessor::setSourceOrdering(bool shouldOrder)
+{
+    if (shouldOrder == sourceOrdering)
+        return;
+
+    sourceOrdering = shouldOrder;
+    if (busStride > 0)
+        allocateBuses();
+}
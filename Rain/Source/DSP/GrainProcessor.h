@@ -5,46 +5,206 @@
 #include "../Extras/LoadedSample.h"
 #include "VoicePool.h"
 #include "VoiceEnvelope.h"
+#include "GrainRenderKernel.h"
+#include "PanTable.h"
+#include "RenderWorkers.h"
+#include "SampleHandoff.h"
+#include "SamplePyramid.h"
 
 class GrainProcessor
 {
 public:
+    GrainProcessor() = default;
+    GrainProcessor(const GrainProcessor&) = delete;
+    GrainProcessor& operator=(const GrainProcessor&) = delete;
+
+    ~GrainProcessor()
+    {
+        sampleHandoff.retire(currentSource);
+        sampleHandoff.retire(fadingSource);
+    }
+
     // Light enough to inline too
     inline void prepare(double sr, int maxBlock) noexcept;
 
+    // Any thread but the audio thread (allocates). The audio thread picks
+    // the sample up at a block start, once any crossfade is over.
     void setSampleSource(const LoadedSample& source)
     {
-		DBG("GrainProcessor::setSampleSource: " << source.buffer->getNumSamples()
-			<< " samples at " << source.sampleRate << " Hz");
-        this->sampleSource = source;
+		DBG("GrainProcessor::setSampleSource: " << source.getNumFrames()
+			<< " samples at " << source.sampleRate << " Hz"
+			<< (source.compact != nullptr ? " (int16)" : ""));
+        sampleHandoff.publish(source);
     }
 
+    // Audio thread, at block start: switch to the newest published sample.
+    // Live grains keep reading the one they started on and end within
+    // kSourceFadeSeconds; new grains read the new one.
+    inline void pickUpSampleSource(GrainPool& pool) noexcept;
+
+    // Frees the samples the audio thread has finished with. Message thread.
+    void releaseRetiredSamples() { sampleHandoff.reclaim(); }
+
+	// Audio thread only; valid until the next pickUpSampleSource
 	const LoadedSample& getSample() const noexcept
 	{
-		return sampleSource;
+		static const LoadedSample none;
+		return currentSource != nullptr ? currentSource->sample : none;
 	}
 
+    // Force a render path, e.g. Isa::Scalar to A/B against the reference loop
+    void setRenderIsa(grain::kernel::Isa newIsa) noexcept
+    {
+        isa = newIsa;
+        kernel = grain::kernel::getKernel(isa, interp, kernelLayout);
+    }
+
+    // Cheap when unchanged, so it can be called every block
+    void setInterpolation(grain::kernel::Interp newInterp) noexcept
+    {
+        if (newInterp == interp)
+            return;
+
+        interp = newInterp;
+        support = grain::kernel::supportOf(interp);
+        kernel = grain::kernel::getKernel(isa, interp, kernelLayout);
+    }
+
+    // Optional parallel PASS 1: helper threads on top of the audio thread.
+    // 0 = render on the audio thread only. Call before prepare, never
+    // while process() may run.
+    void setRenderThreads(int numHelpers);
+    int  getNumRenderHelpers() const noexcept { return workers.getNumHelpers(); }
+
+    // Optional PASS 1 scheduling: render grains sorted by source position,
+    // prefetching each next grain's frames, so long files with scattered
+    // grains miss the cache less. Same call rules as setRenderThreads.
+    void setSourceOrdering(bool shouldOrder);
+
+    // Size the per-grain scratch to the GrainPool capacity. Same call rules.
+    void setGrainCapacity(std::size_t capacity);
+
+    // Grains whose gain × voice level stays below this (linear) for the
+    // block are advanced without rendering. 0 renders every grain.
+    void setSilenceThreshold(float gain) noexcept { silenceThreshold = gain; }
+
     // Hot path – body is in .inl
     inline void process(GrainPool& pool, VoicePool& voices, juce::AudioBuffer<float>& output) noexcept;
 
 private:
-    inline float* busPtr(std::size_t voice, int ch) noexcept
+    static constexpr int kMinGrainsPerTask = 64;    // below this PASS 1 stays single-threaded
+    static constexpr int kTasksPerThread = 2;       // spare tasks to even out grain lengths
+
+    static constexpr int kOrderBlockShift = 12;     // sort key: 4096-frame source blocks
+    static constexpr int kOrderRadixBits = 11;      // two passes → 2^22 blocks
+    static constexpr int kMinGrainsToOrder = 32;    // fewer: sorting costs more than it saves
+    static constexpr int kPrefetchBytes = 2048;     // per channel, of the next grain's window
+
+    static constexpr double kSourceFadeSeconds = 0.1;   // longest a replaced sample keeps sounding
+
+    /* Everything a grain render needs that is fixed for the block */
+    struct BlockInfo
+    {
+        const juce::AudioBuffer<float>* src;        // null when compact
+        const CompactBuffer* compact;               // int16 frames, or null
+        int nSrcCh, nSrcFrames;
+        int srcEnd;                                 // read head must stay below this
+        const SamplePyramid* pyramid;               // null: level 0 only
+        int nOutCh, nOutFrames;
+        grain::kernel::Kernel kernel;               // for this source's channel layout
+        grain::kernel::Layout layout;
+        const BlockInfo* fading;                    // the previous sample (GrainPool::oldSource), or null
+    };
+
+    /* dirty[] slot of the direct output (see directLevel) */
+    static constexpr int kDirectSlot = VoicePool::kMaxBuses;
+
+    /* Private buses of one parallel task, summed into voiceBus afterwards */
+    struct TaskBuses
     {
-        return voiceBus.data() + ((voice * 2 + ch) * busStride);
+        std::vector<float> bus;                     // same layout as voiceBus
+        bool               dirty[VoicePool::kMaxBuses + 1]{};
+        int                framesUsed = 0;
+        std::vector<float> env;
+        std::vector<float> direct;                  // 2 channels, busStride each; added to the output
+        float*             directCh[2]{};
+    };
+
+    struct ParallelJob
+    {
+        GrainProcessor*  self;
+        GrainPool*       pool;
+        const VoicePool* voices;
+        BlockInfo        blk;
+        int              numTasks;
+        const uint16_t*  order;                     // render order, null = active-list order
+    };
+
+    inline void allocateBuses();
+    inline void clearDirtyBuses(float* buses, bool* dirty, int frames, int nOutCh) noexcept;
+    inline bool renderGrain(GrainPool& pool, const VoicePool& voices, std::size_t g,
+                            const BlockInfo& blk, float* buses, bool* dirty, float* env,
+                            float* const* direct) noexcept;
+    inline void renderRange(GrainPool& pool, const VoicePool& voices, const BlockInfo& blk,
+                            const uint16_t* order, int begin, int end,
+                            float* buses, bool* dirty, float* env, float* const* direct) noexcept;
+    inline void finishSourceFade(GrainPool& pool) noexcept;
+    inline void orderBySource(const GrainPool& pool) noexcept;
+    inline void prefetchSource(const GrainPool& pool, std::size_t g, const BlockInfo& blk) const noexcept;
+    inline int  sourceLevel(const BlockInfo& blk, uint64_t step) const noexcept;
+    static inline void renderTask(void* context, int task) noexcept;
+
+    // Buses are indexed by VoicePool::bus[voice], not by the voice itself
+    inline std::size_t busOffset(std::size_t bus, int ch) const noexcept
+    {
+        return (bus * 2 + ch) * static_cast<std::size_t>(busStride);
+    }
+
+    inline float* busPtr(std::size_t bus, int ch) noexcept
+    {
+        return voiceBus.data() + busOffset(bus, ch);
     }
 
     inline std::size_t totalBusSamples() const noexcept
     {
-        return static_cast<std::size_t>(VoicePool::kMaxVoices) * 2 * busStride;
+        return static_cast<std::size_t>(VoicePool::kMaxBuses) * 2 * busStride;
     }
 
     double sampleRate = 44100.0;
     int    maxBlockSize = 512;
 
-	LoadedSample sampleSource;
+    SampleHandoff        sampleHandoff;
+    SampleHandoff::Entry* currentSource = nullptr;   // owned by the audio thread
+    SampleHandoff::Entry* fadingSource = nullptr;    // replaced, its grains still fading
+    int                  fadeFramesLeft = 0;        // until fadingSource is retired
 
     std::vector<float> voiceBus;
     int                busStride = 0;
+    bool               busDirty[VoicePool::kMaxBuses + 1]{}; // written since last clear (+ direct slot)
+    int                busFramesUsed = 0;                   // frames written last callback
+    std::vector<float> gainRamp;                           // voice ADSR per bus, busStride each
+
+    std::vector<float>       envScratch;                       // one ramp segment, busStride long
+
+    // Voices in sustain hold one level for the whole block. Their grains
+    // fold it into the gain and add straight into the output, skipping the
+    // bus and its gain ramp. -1 = render through the voice bus.
+    float                    directLevel[VoicePool::kMaxVoices]{};
+    grain::kernel::Kernel    kernel = grain::kernel::kScalarKernel;
+    grain::kernel::Isa       isa = grain::kernel::Isa::Scalar;
+    grain::kernel::Interp    interp = grain::kernel::Interp::Linear;
+    grain::kernel::Layout    kernelLayout = grain::kernel::Layout::Mono;   // of the current sample / output
+    grain::kernel::Support   support = grain::kernel::supportOf(grain::kernel::Interp::Linear);
+
+    RenderWorkers            workers;
+    std::vector<TaskBuses>   taskBuses;                        // empty when single-threaded
+    std::vector<uint8_t>     grainFinished;                    // by active-list position
+    std::size_t              grainCapacity = GrainPool::kDefaultCapacity;
+
+    bool                     sourceOrdering = false;
+    float                    silenceThreshold = 0.0f;          // linear gain
+    std::vector<uint16_t>    renderOrder, orderScratch;        // active-list positions
+    std::vector<uint32_t>    orderKeys, keyScratch;            // source block per position
 };
 
 // Pull inline bodies into every TU that includes this header.
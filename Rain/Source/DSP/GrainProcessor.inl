@@ -5,31 +5,35 @@
 #include "GrainProcessor.h"
 #include "VoiceEnvelope.h"
 #include "SamplePosition.h"
+#include "GrainWindow.h"
+#include "GrainEnvelope.h"
 
 #include <algorithm>   // std::fill_n
-#include <cmath>       // std::pow
+#include <utility>     // std::exchange
 
 /*──────────────────────────────────────────────────────────────────────────────
-  prepare – allocate per-voice scratch buses once at start-up
+  prepare – allocate the render buses once at start-up
 ──────────────────────────────────────────────────────────────────────────────*/
 inline void GrainProcessor::prepare(double sr, int maxBlock) noexcept
 {
     sampleRate = sr;
 
     busStride = maxBlock;                                    // frames / channel
-    const std::size_t total =
-        static_cast<std::size_t>(VoicePool::kMaxVoices) * 2 * busStride;
+    allocateBuses();
 
-    voiceBus.assign(total, 0.0f);                            // allocate & zero
+    isa = grain::kernel::detectIsa();
+    kernel = grain::kernel::getKernel(isa, interp, kernelLayout);
 
 #if JUCE_DEBUG
     DBG("voiceBus alloc: "
-        << (total * sizeof(float)) / 1024 << " kB   stride = " << busStride);
+        << (totalBusSamples() * sizeof(float)) / 1024 << " kB   stride = " << busStride
+        << "   render helpers = " << workers.getNumHelpers()
+        << "   render kernel = " << grain::kernel::getIsaName(isa));
 #endif
 }
 
 /*──────────────────────────────────────────────────────────────────────────────
-  process – render one audio block
+  process – render one sub-block (at most the prepared length)
 ──────────────────────────────────────────────────────────────────────────────*/
 inline void GrainProcessor::process(GrainPool& pool,
     VoicePool& voices,
@@ -40,177 +44,593 @@ inline void GrainProcessor::process(GrainPool& pool,
     const int nOutFrames = output.getNumSamples();
     const int nOutCh = output.getNumChannels();
 
-    /* ───────── grow bus if host delivers a larger buffer ────────────── */
-    if (voiceBus.empty() || nOutFrames > busStride)
+    // GrainEngine splits host blocks into sub-blocks no longer than prepare's
+    jassert(!voiceBus.empty() && nOutFrames <= busStride);
+    if (nOutFrames > busStride)
+        return;
+
+    /* ───────── resolve sample source ─────────────────────────────────── */
+    const LoadedSample& sampleSource = getSample();
+    if (!sampleSource.hasAudio())
+        return;                                               // no sample loaded
+
+    const int nSrcCh = sampleSource.getNumChannels();
+    const int nSrcFrames = sampleSource.getNumFrames();
+
+    // The kernels are built per channel layout; refetch when it changes
+    if (const auto layout = grain::kernel::layoutFor(nSrcCh, nOutCh); layout != kernelLayout)
     {
-        busStride = nOutFrames;                                // grow, never shrink
-        const std::size_t total =
-            static_cast<std::size_t>(VoicePool::kMaxVoices) * 2 * busStride;
+        kernelLayout = layout;
+        kernel = grain::kernel::getKernel(isa, interp, kernelLayout);
+    }
+
+    /* ───────── clear only the buses written last callback ────────────── */
+    clearDirtyBuses(voiceBus.data(), busDirty, busFramesUsed, nOutCh);
+    busDirty[kDirectSlot] = false;                            // direct grains wrote to the output
+    busFramesUsed = nOutFrames;
+
+    BlockInfo blk{ sampleSource.buffer.get(), sampleSource.compact.get(),
+                   nSrcCh, nSrcFrames, nSrcFrames - support.after,
+                   sampleSource.pyramid.get(), nOutCh, nOutFrames,
+                   kernel, kernelLayout, nullptr };
 
-        voiceBus.assign(total, 0.0f);                        // re-alloc & zero
+    // Compact and float storage never mix between level 0 and the pyramid
+    jassert(blk.pyramid == nullptr || blk.pyramid->isCompact() == (blk.compact != nullptr));
+
+    // Grains still fading out on a replaced sample read it through their own
+    // block info; its channel layout may differ from the new sample's
+    BlockInfo fadingBlk{};
+    if (fadingSource != nullptr)
+    {
+        const LoadedSample& old = fadingSource->sample;
+        const auto          layout = grain::kernel::layoutFor(old.getNumChannels(), nOutCh);
+        fadingBlk = { old.buffer.get(), old.compact.get(),
+                      old.getNumChannels(), old.getNumFrames(), old.getNumFrames() - support.after,
+                      old.pyramid.get(), nOutCh, nOutFrames,
+                      grain::kernel::getKernel(isa, interp, layout), layout, nullptr };
+        blk.fading = &fadingBlk;
     }
 
-    jassert(nOutFrames <= busStride);
+    // Grains still waiting on their start delay stay on the timing wheel
+    pool.activateDue(nOutFrames);
 
-    /* ───────── resolve sample source ─────────────────────────────────── */
-    const auto* srcBuf = sampleSource.buffer.get();
-    if (srcBuf == nullptr)
-        return;                                               // no sample loaded
+    // Sustain is the one stage whose level cannot move inside the block
+    // (note-offs are already applied). Mono / stereo output only.
+    float* directOut[2] = {};
+    for (int ch = 0; ch < std::min(nOutCh, 2); ++ch)
+        directOut[ch] = output.getWritePointer(ch);
+    for (std::size_t v = 0; v < VoicePool::kMaxVoices; ++v)
+        directLevel[v] = nOutCh <= 2 && voices.active.test(v) && voices.stage[v] == Stage::Sustain
+                       ? voices.sustainLevel[v] : -1.0f;
 
-    const int nSrcCh = srcBuf->getNumChannels();
-    const int nSrcFrames = srcBuf->getNumSamples();
+    /*──────────────────────────────────────────────────────────────────────
+      PASS 1 – grains → voice buses
+    ──────────────────────────────────────────────────────────────────────*/
+    const int numTasks = std::min(static_cast<int>(taskBuses.size()),
+                                  pool.numActive / kMinGrainsPerTask);
 
-    /* ───────── clear the slice we touch this callback ────────────────── */
-    std::fill_n(voiceBus.data(),
-        static_cast<std::size_t>(VoicePool::kMaxVoices) * 2 * nOutFrames,
-        0.0f);
+    const bool ordered = sourceOrdering && pool.numActive >= kMinGrainsToOrder;
+    if (ordered)
+        orderBySource(pool);
+    const uint16_t* order = ordered ? renderOrder.data() : nullptr;
 
-    /* ───────── helper: grain ASR envelope ────────────────────────────── */
-    const auto grainEnv = [&](std::size_t gi, int framesLeft) -> float
+    if (numTasks < 2 && order == nullptr)
+    {
+        // Walk the dense list backwards: release() swap-removes, pulling an
+        // already-visited grain into the current position.
+        for (int i = pool.numActive - 1; i >= 0; --i)
         {
-            const int total = pool.length[gi];
-            const int atk = pool.envAttackFrames[gi];
-            const int rel = pool.envReleaseFrames[gi];
-
-            if (total <= 0 || atk + rel >= total)
-                return 0.0f;
+            const std::size_t g = pool.activeList[i];
+            if (!renderGrain(pool, voices, g, blk, voiceBus.data(), busDirty, envScratch.data(), directOut))
+                pool.release(g);
+        }
+    }
+    else
+    {
+        if (numTasks < 2)
+        {
+            renderRange(pool, voices, blk, order, 0, pool.numActive,
+                        voiceBus.data(), busDirty, envScratch.data(), directOut);
+        }
+        else
+        {
+            ParallelJob job{ this, &pool, &voices, blk, numTasks, order };
+            workers.run(&GrainProcessor::renderTask, &job, numTasks);
 
-            if (framesLeft > total - atk)                      // attack
+            /* reduce in task order, so the sum never depends on scheduling */
+            for (int t = 0; t < numTasks; ++t)
             {
-                const float t = float(total - framesLeft) / atk;
-                return std::pow(t, pool.envAttackCurve[gi]);
+                const TaskBuses& tb = taskBuses[static_cast<std::size_t>(t)];
+                if (!tb.dirty[kDirectSlot])
+                    continue;
+
+                for (int ch = 0; ch < nOutCh; ++ch)
+                {
+                    const float* src = tb.directCh[ch];
+                    float*       dst = directOut[ch];
+                    for (int s = 0; s < nOutFrames; ++s)
+                        dst[s] += src[s];
+                }
             }
-            if (framesLeft < rel)                              // release
+
+            for (int b = 0; b < VoicePool::kMaxBuses; ++b)
             {
-                const float t = float(rel - framesLeft) / rel;
-                return std::pow(1.0f - t, pool.envReleaseCurve[gi]);
+                for (int t = 0; t < numTasks; ++t)
+                {
+                    const TaskBuses& tb = taskBuses[static_cast<std::size_t>(t)];
+                    if (!tb.dirty[b])
+                        continue;
+
+                    busDirty[b] = true;
+                    for (int ch = 0; ch < nOutCh; ++ch)
+                    {
+                        const float* src = tb.bus.data() + busOffset(b, ch);
+                        float*       dst = busPtr(b, ch);
+                        for (int s = 0; s < nOutFrames; ++s)
+                            dst[s] += src[s];
+                    }
+                }
             }
-            return 1.0f;                                       // sustain
-        };
+        }
+
+        /* releases were deferred: the list must not move while rendering */
+        for (int i = pool.numActive - 1; i >= 0; --i)
+            if (grainFinished[static_cast<std::size_t>(i)])
+                pool.release(pool.activeList[i]);
+    }
 
     /*──────────────────────────────────────────────────────────────────────
-      PASS 1 – grains → voice buses
+      PASS 2 – voice ADSR for the whole block, then bus × gain ramp → output
     ──────────────────────────────────────────────────────────────────────*/
-    for (std::size_t g = 0; g < GrainPool::kMaxGrains; ++g)
+    // Collect the buses to mix first: a voice that goes idle inside the
+    // block hands its bus back, but its ramp is still valid (zero tail).
+    int mixBuses[VoicePool::kMaxBuses];
+    int numMix = 0;
+    for (std::size_t v = 0; v < VoicePool::kMaxVoices; ++v)
     {
-        if (!pool.active[g])
-            continue;
+        const int b = voices.bus[v];
+        if (voices.active.test(v) && b >= 0 && busDirty[b])
+            mixBuses[numMix++] = b;
+    }
 
-        /* guard: valid voice index -------------------------------------- */
-        const int voiceId = pool.voiceIdx[g];
-        if (voiceId < 0 || voiceId >= VoicePool::kMaxVoices)
-        {
-            DBG("*** BAD voiceId " << voiceId << "  in grain " << g);
-            pool.active.reset(g);
-            continue;
-        }
+    voice::env::renderBlock(voices, gainRamp.data(), busStride, nOutFrames);
 
-        /* A. handle start delay ----------------------------------------- */
-        int delay = pool.delay[g];
-        if (delay >= nOutFrames)
+    for (int ch = 0; ch < std::min(nOutCh, 2); ++ch)
+    {
+        float* out = output.getWritePointer(ch);
+
+        for (int i = 0; i < numMix; ++i)
         {
-            pool.delay[g] = delay - nOutFrames;
-            continue;
+            const float* ramp = gainRamp.data() + static_cast<std::size_t>(mixBuses[i]) * busStride;
+            const float* bus  = busPtr(mixBuses[i], ch);
+
+            for (int s = 0; s < nOutFrames; ++s)
+                out[s] += ramp[s] * bus[s];
         }
+    }
 
-        const int startFrame = std::max(0, delay);
-        const int wantFrames = std::min(pool.frames[g],
-            nOutFrames - startFrame);
+    pool.advanceClock(nOutFrames);
 
-        double      readPos = pool.samplePos[g];
-        const double step = pool.step[g];
-        const int    maxSrc = samplePosition::availableOutputFrames(nSrcFrames, readPos, step);
-        const int    framesHere = std::min(wantFrames, maxSrc);
+    fadeFramesLeft -= nOutFrames;
+    if (fadingSource != nullptr && fadeFramesLeft <= 0)
+        finishSourceFade(pool);
+}
 
-        /* guard: frame count -------------------------------------------- */
-        if (framesHere <= 0 || startFrame + framesHere > nOutFrames)
-        {
-            DBG("*** BAD framesHere (" << framesHere << ") in grain " << g);
-            pool.active.reset(g);
-            continue;
-        }
+/*──────────────────────────────────────────────────────────────────────────────
+  pickUpSampleSource – adopt the newest published sample at block start
+──────────────────────────────────────────────────────────────────────────────*/
+inline void GrainProcessor::pickUpSampleSource(GrainPool& pool) noexcept
+{
+    // One crossfade at a time: a newer sample waits in the mailbox (and
+    // replaces any it finds there) until the current fade is over
+    if (fadingSource != nullptr)
+        return;
+
+    SampleHandoff::Entry* next = sampleHandoff.take();
+    if (next == nullptr)
+        return;
+
+    // Waiting grains picked their position and step in the old sample
+    pool.dropPending();
+
+    // Live grains stay on the sample they started on while new grains come
+    // in on the new one under their own attack: the crossfade is the grains'
+    // own envelopes. Cutting them short instead leaves a hole as long as the
+    // new grains' attack, so only grains outlasting the fade are shortened.
+    const int fadeFrames = static_cast<int>(kSourceFadeSeconds * sampleRate + 0.5);
+    for (int i = 0; i < pool.numActive; ++i)
+    {
+        const std::size_t g = pool.activeList[i];
+        pool.oldSource[g] = true;
+        if (pool.delay[g] + pool.frames[g] > fadeFrames)
+            grain::env::fadeOut(pool, g, std::max(fadeFrames - pool.delay[g], 1));
+    }
 
-        /* B. static grain gain + pan ------------------------------------ */
-        const float baseGain = pool.gain[g];
-        const float pan = pool.pan[g];
-        const auto  gChGain = [=](int ch) -> float
-            {
-                if (nOutCh == 1)
-                    return baseGain;
-                return (ch == 0)
-                    ? baseGain * (1.0f - pan) * 0.5f
-                    : baseGain * (1.0f + pan) * 0.5f;
-            };
+    if (pool.numActive > 0 && currentSource != nullptr)
+    {
+        fadingSource = currentSource;
+        fadeFramesLeft = fadeFrames + busStride;              // + a grain's start delay
+    }
+    else
+    {
+        sampleHandoff.retire(currentSource);
+    }
+
+    currentSource = next;
+}
+
+/* Drop whatever still reads fadingSource and hand it back for freeing */
+inline void GrainProcessor::finishSourceFade(GrainPool& pool) noexcept
+{
+    for (int i = pool.numActive - 1; i >= 0; --i)
+        if (pool.oldSource[pool.activeList[i]])
+            pool.release(pool.activeList[i]);
+
+    sampleHandoff.retire(std::exchange(fadingSource, nullptr));
+}
+
+/*──────────────────────────────────────────────────────────────────────────────
+  allocateBuses – shared buses, envelope ramps and one bus set per task
+──────────────────────────────────────────────────────────────────────────────*/
+inline void GrainProcessor::allocateBuses()
+{
+    const std::size_t stride = static_cast<std::size_t>(busStride);
+
+    voiceBus.assign(totalBusSamples(), 0.0f);
+    std::fill(std::begin(busDirty), std::end(busDirty), false);
+    busFramesUsed = 0;
+    gainRamp.assign(static_cast<std::size_t>(VoicePool::kMaxBuses) * stride, 0.0f);
+    envScratch.assign(stride, 0.0f);
+
+    const int helpers = workers.getNumHelpers();
+    taskBuses.resize(helpers > 0 ? static_cast<std::size_t>((helpers + 1) * kTasksPerThread) : 0);
+    for (auto& tb : taskBuses)
+    {
+        tb.bus.assign(totalBusSamples(), 0.0f);
+        std::fill(std::begin(tb.dirty), std::end(tb.dirty), false);
+        tb.framesUsed = 0;
+        tb.env.assign(stride, 0.0f);
+        tb.direct.assign(2 * stride, 0.0f);
+        tb.directCh[0] = tb.direct.data();
+        tb.directCh[1] = tb.direct.data() + stride;
+    }
+    grainFinished.assign(helpers > 0 || sourceOrdering ? grainCapacity : 0, 0);
+
+    const std::size_t orderSize = sourceOrdering ? grainCapacity : 0;
+    renderOrder.assign(orderSize, 0);
+    orderScratch.assign(orderSize, 0);
+    orderKeys.assign(orderSize, 0);
+    keyScratch.assign(orderSize, 0);
+}
+
+inline void GrainProcessor::clearDirtyBuses(float* buses, bool* dirty, int frames, int nOutCh) noexcept
+{
+    for (int b = 0; b < VoicePool::kMaxBuses; ++b)
+    {
+        if (!dirty[b])
+            continue;
 
-        /* C. inner sample loop ------------------------------------------ */
         for (int ch = 0; ch < nOutCh; ++ch)
+            std::fill_n(buses + busOffset(b, ch), frames, 0.0f);
+        dirty[b] = false;
+    }
+}
+
+/*──────────────────────────────────────────────────────────────────────────────
+  renderTask – one contiguous slice of the active list into the task's buses
+──────────────────────────────────────────────────────────────────────────────*/
+inline void GrainProcessor::renderTask(void* context, int task) noexcept
+{
+    auto&       job  = *static_cast<ParallelJob*>(context);
+    auto&       self = *job.self;
+    GrainPool&  pool = *job.pool;
+    TaskBuses&  tb   = self.taskBuses[static_cast<std::size_t>(task)];
+
+    self.clearDirtyBuses(tb.bus.data(), tb.dirty, tb.framesUsed, job.blk.nOutCh);
+    if (std::exchange(tb.dirty[kDirectSlot], false))
+        std::fill(tb.direct.begin(), tb.direct.end(), 0.0f);
+    tb.framesUsed = job.blk.nOutFrames;
+
+    const int begin = static_cast<int>(int64_t(pool.numActive) * task / job.numTasks);
+    const int end   = static_cast<int>(int64_t(pool.numActive) * (task + 1) / job.numTasks);
+
+    self.renderRange(pool, *job.voices, job.blk, job.order, begin, end,
+                     tb.bus.data(), tb.dirty, tb.env.data(), tb.directCh);
+}
+
+/*──────────────────────────────────────────────────────────────────────────────
+  renderRange – grains [begin, end) of `order` (or of the active list),
+  marking finished ones in grainFinished instead of releasing them
+──────────────────────────────────────────────────────────────────────────────*/
+inline void GrainProcessor::renderRange(GrainPool& pool, const VoicePool& voices, const BlockInfo& blk,
+                                        const uint16_t* order, int begin, int end,
+                                        float* buses, bool* dirty, float* env,
+                                        float* const* direct) noexcept
+{
+    for (int i = begin; i < end; ++i)
+    {
+        const int pos = order != nullptr ? order[i] : i;
+
+        // The next grain's frames load while this one renders
+        if (order != nullptr && i + 1 < end)
+            prefetchSource(pool, pool.activeList[order[i + 1]], blk);
+
+        grainFinished[static_cast<std::size_t>(pos)] =
+            !renderGrain(pool, voices, pool.activeList[pos], blk, buses, dirty, env, direct);
+    }
+}
+
+/*──────────────────────────────────────────────────────────────────────────────
+  orderBySource – active-list positions into renderOrder, sorted by the
+  source block each read head is in. LSD radix sort, stable, so grains in
+  one block keep their active-list order; the second pass only runs for
+  files longer than 2^(kOrderBlockShift + kOrderRadixBits) frames.
+──────────────────────────────────────────────────────────────────────────────*/
+inline void GrainProcessor::orderBySource(const GrainPool& pool) noexcept
+{
+    constexpr uint32_t kBuckets = 1u << kOrderRadixBits;
+    constexpr uint32_t kMaxKey = (1u << (2 * kOrderRadixBits)) - 1;
+    constexpr int      kKeyShift = samplePosition::kFracBits + kOrderBlockShift;
+
+    const int n = pool.numActive;
+    uint32_t  maxKey = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        const uint64_t block = pool.samplePos[pool.activeList[i]] >> kKeyShift;
+        orderKeys[static_cast<std::size_t>(i)] = static_cast<uint32_t>(std::min<uint64_t>(block, kMaxKey));
+        maxKey = std::max(maxKey, orderKeys[static_cast<std::size_t>(i)]);
+    }
+
+    uint32_t count[kBuckets];
+    const auto pass = [&](const uint32_t* keys, const uint16_t* from, int shift,
+                          uint16_t* to, uint32_t* keysOut)
         {
-            const int    srcCh = std::min(ch, nSrcCh - 1);
-            const float* src = srcBuf->getReadPointer(srcCh);
-            float* dst = busPtr(voiceId, ch) + startFrame;
-
-            /* guard: pointer range -------------------------------------- */
-            const std::size_t offs =
-                static_cast<std::size_t>((voiceId * 2 + ch) * busStride + startFrame);
-            if (offs + framesHere > voiceBus.size())
+            std::fill(std::begin(count), std::end(count), 0u);
+            for (int i = 0; i < n; ++i)
+                ++count[(keys[i] >> shift) & (kBuckets - 1)];
+
+            uint32_t sum = 0;
+            for (auto& c : count)
+                sum += std::exchange(c, sum);
+
+            for (int i = 0; i < n; ++i)
             {
-                DBG("*** BUS overrun risk in grain " << g
-                    << "  ch=" << ch << "  offs=" << offs
-                    << "  frames=" << framesHere
-                    << "  total=" << voiceBus.size());
-                pool.active.reset(g);
-                break;
+                const uint32_t at = count[(keys[i] >> shift) & (kBuckets - 1)]++;
+                to[at] = from != nullptr ? from[i] : static_cast<uint16_t>(i);
+                if (keysOut != nullptr)
+                    keysOut[at] = keys[i];
             }
+        };
 
-            double      rp = readPos;
-            int         fL = pool.frames[g];
-            const float gCh = gChGain(ch);
+    if (maxKey < kBuckets)
+    {
+        pass(orderKeys.data(), nullptr, 0, renderOrder.data(), nullptr);
+        return;
+    }
 
-            for (int s = 0; s < framesHere; ++s, --fL)
-            {
-                const float env = grainEnv(g, fL);
-                const int   idx = int(rp);
-                const float frac = float(rp - idx);
-                const float samp = src[idx] + frac * (src[idx + 1] - src[idx]);
+    pass(orderKeys.data(), nullptr, 0, orderScratch.data(), keyScratch.data());
+    pass(keyScratch.data(), orderScratch.data(), kOrderRadixBits, renderOrder.data(), nullptr);
+}
 
-                dst[s] += gCh * env * samp;
-                rp += step;
-            }
+/*──────────────────────────────────────────────────────────────────────────────
+  prefetchSource – touch the frames grain g reads this block, per channel
+──────────────────────────────────────────────────────────────────────────────*/
+inline void GrainProcessor::prefetchSource(const GrainPool& pool, std::size_t g,
+                                           const BlockInfo& block) const noexcept
+{
+    const BlockInfo& blk = pool.oldSource[g] && block.fading != nullptr ? *block.fading : block;
+    const uint64_t step  = pool.step[g];
+    const int      level = sourceLevel(blk, step);
+    const int      first = std::max(0, samplePosition::wholeFrames(pool.samplePos[g] >> level) - support.before);
+    const int      span  = samplePosition::wholeFrames((step >> level) * static_cast<uint64_t>(blk.nOutFrames))
+                         + support.before + support.after + 1;
+
+    for (int ch = 0; ch < std::min(blk.nSrcCh, 2); ++ch)
+    {
+        const char* base;
+        int         bytes;
+        if (blk.compact != nullptr)
+        {
+            const CompactBuffer& frames = level > 0 ? blk.pyramid->getCompactLevel(level) : *blk.compact;
+            base  = reinterpret_cast<const char*>(frames.getReadPointer(ch) + first);
+            bytes = span * static_cast<int>(sizeof(int16_t));
+        }
+        else
+        {
+            const float* src = level > 0 ? blk.pyramid->getReadPointer(level, ch) : blk.src->getReadPointer(ch);
+            base  = reinterpret_cast<const char*>(src + first);
+            bytes = span * static_cast<int>(sizeof(float));
         }
 
-        /* D. bookkeeping ------------------------------------------------ */
-        pool.samplePos[g] += step * framesHere;
-        pool.frames[g] -= framesHere;
-        pool.delay[g] = 0;
-        if (pool.frames[g] <= 0 || pool.samplePos[g] >= nSrcFrames - 1)
-            pool.active.reset(g);
+        for (int b = 0; b < std::min(bytes, kPrefetchBytes); b += 64)
+            grain::kernel::prefetch(base + b);
     }
+}
 
-    /*──────────────────────────────────────────────────────────────────────
-      PASS 2 – update voice ADSR once per sample, mix buses to output
-    ──────────────────────────────────────────────────────────────────────*/
-    float* outL = output.getWritePointer(0);
-    float* outR = (nOutCh > 1) ? output.getWritePointer(1) : nullptr;
+/* Pyramid level a grain with this step reads from (0 without a pyramid) */
+inline int GrainProcessor::sourceLevel(const BlockInfo& blk, uint64_t step) const noexcept
+{
+    return blk.pyramid != nullptr
+         ? std::min(SamplePyramid::levelForStep(samplePosition::toDouble(step)), blk.pyramid->getNumLevels() - 1)
+         : 0;
+}
+
+/*──────────────────────────────────────────────────────────────────────────────
+  renderGrain – advance one grain through this block, adding it to `buses`
+  (or to `direct`, the output channels, if its voice is in sustain).
+  Touches only grain g's pool fields, so tasks may call it concurrently.
+  Returns false once the grain is finished and must be released.
+──────────────────────────────────────────────────────────────────────────────*/
+inline bool GrainProcessor::renderGrain(GrainPool& pool, const VoicePool& voices, std::size_t g,
+                                        const BlockInfo& block, float* buses, bool* dirty,
+                                        float* env, float* const* direct) noexcept
+{
+    // A grain that outlived its sample's replacement keeps reading the old one
+    const BlockInfo& blk = pool.oldSource[g] && block.fading != nullptr ? *block.fading : block;
+    const int nOutFrames = blk.nOutFrames;
+    const int nOutCh = blk.nOutCh;
+
+    /* guard: valid voice index -------------------------------------- */
+    const int voiceId = pool.voiceIdx[g];
+    if (voiceId < 0 || voiceId >= VoicePool::kMaxVoices)
+    {
+        DBG("*** BAD voiceId " << voiceId << "  in grain " << g);
+        return false;
+    }
+    const int bus = voices.bus[voiceId];                      // -1: voice is not sounding
+
+    // The voice went idle (release or decay ran out): its grains, live or
+    // just out of their start delay, can never be heard again
+    if (!voices.active.test(static_cast<std::size_t>(voiceId)))
+        return false;
+
+    // Past the attack a voice only gets quieter, so a grain below the
+    // threshold at the start of the block stays below it to the end
+    const float voicePeak = voices.stage[voiceId] == Stage::Attack ? 1.0f : voices.level[voiceId];
+    const bool  audible = bus >= 0 && pool.gain[g] * voicePeak >= silenceThreshold;
+
+    /* A. handle start delay ----------------------------------------- */
+    // activateDue() only lists grains that start in this block, so the
+    // skip branch is a guard for grains placed on the list directly.
+    int delay = pool.delay[g];
+    if (delay >= nOutFrames)
+    {
+        pool.delay[g] = delay - nOutFrames;
+        return true;
+    }
+
+    const int startFrame = std::max(0, delay);
+    const int wantFrames = std::min(pool.frames[g],
+        nOutFrames - startFrame);
+
+    const uint64_t readPos = pool.samplePos[g];                // 32.32 fixed
+    const uint64_t step = pool.step[g];
+    const int    maxSrc = samplePosition::availableOutputFrames(blk.nSrcFrames, readPos, step, support.after);
+    const int    framesHere = std::min(wantFrames, maxSrc);
+
+    /* guard: frame count -------------------------------------------- */
+    if (framesHere <= 0 || startFrame + framesHere > nOutFrames)
+    {
+        DBG("*** BAD framesHere (" << framesHere << ") in grain " << g);
+        return false;
+    }
+
+    /* B. static grain gain + pan ------------------------------------ */
+    // A sustained voice's level rides on the gain instead of the bus ramp
+    const float directGain = directLevel[voiceId];
+    const bool  toOutput = directGain >= 0.0f;
+    const float baseGain = toOutput ? pool.gain[g] * directGain : pool.gain[g];
+    const auto  panGains = grain::pan::constantPower(pool.pan[g]);
+    const int   nDst = nOutCh == 1 ? 1 : 2;             // outputs past the first two stay silent
+    float       gains[2] = { baseGain, baseGain };
+    if (nDst == 2)
+    {
+        gains[0] *= panGains.left;
+        gains[1] *= panGains.right;
+    }
 
-    for (int s = 0; s < nOutFrames; ++s)
+    /* guard: pointer range ---------------------------------------- */
+    const std::size_t offs = busOffset(bus, nOutCh - 1) + startFrame;
+    if (bus >= 0 && offs + framesHere > totalBusSamples())
     {
-        voice::env::updateOneSample(voices);             // all voices, once
+        DBG("*** BUS overrun risk in grain " << g
+            << "  offs=" << offs
+            << "  frames=" << framesHere
+            << "  total=" << totalBusSamples());
+        return false;
+    }
+
+    /* C. walk the envelope stages: ramp · flat · ramp --------------- */
+    // An inaudible grain keeps running (no render) so it stays in step
+    // should it get loud enough again, e.g. on a retrigger.
+    if (audible)
+        dirty[toOutput ? kDirectSlot : bus] = true;
+
+    const auto& windows = grain::window::getTables();
+
+    /* pick the octave level whose rate suits this grain's step ---------- */
+    // Level L frame i sits at level-0 frame i * 2^L, so position and step
+    // scale by a shift (dropping L fraction bits at most); bounds are
+    // already guaranteed by the level-0 checks.
+    const int      level  = sourceLevel(blk, step);
+    const uint64_t lvPos  = readPos >> level;
+    const uint64_t lvStep = step >> level;
 
-        float mixL = 0.0f, mixR = 0.0f;
+    // Host-rate sample at unity pitch (or an octave above, via the pyramid)
+    // and a read head on a whole frame: no interpolation needed.
+    const bool unitStep = lvStep == (uint64_t(1) << samplePosition::kFracBits)
+                       && (lvPos & samplePosition::kFracMask) == 0;
 
-        for (std::size_t v = 0; v < VoicePool::kMaxVoices; ++v)
+    for (int done = 0; audible && done < framesHere && pool.envStage[g] != GrainStage::Done;)
+    {
+        const GrainStage stage = pool.envStage[g];
+        const int        left = pool.envStageLeft[g];
+        const int        n = std::min(framesHere - done, left);
+
+        const float* envHere = nullptr;                       // sustain: flat copy-add
+        if (stage == GrainStage::Attack)
         {
-            if (!voices.active.test(v))
-                continue;
+            const int   len = pool.envAttackFrames[g];
+            const float inc = float(grain::window::kTableSize) / float(len);
+            grain::window::fillRamp(windows.ramp[pool.envAttackRow[g]],
+                                    float(len - left) * inc, inc, env, n);
+            envHere = env;
+        }
+        else if (stage == GrainStage::Release)
+        {
+            const float inc = float(grain::window::kTableSize) / float(pool.envReleaseFrames[g]);
+            grain::window::fillRamp(windows.ramp[pool.envReleaseRow[g]],
+                                    float(left) * inc, -inc, env, n);
+            envHere = env;
+        }
 
-            const float vGain = voices.level[v];
-            mixL += vGain * busPtr(v, 0)[s];
-            if (outR)
-                mixR += vGain * busPtr(v, 1)[s];
+        /* D. inner sample loop (SIMD kernel) ------------------------ */
+        // One call covers every output: the layout's kernel reads each
+        // source frame once and writes it to both sides
+        const uint64_t rp = lvPos + lvStep * static_cast<uint64_t>(done);
+        float*         dst[2];
+        for (int ch = 0; ch < nDst; ++ch)
+            dst[ch] = (toOutput ? direct[ch] : buses + busOffset(bus, ch)) + startFrame + done;
+
+        const auto mix = [&](const auto* const* src, auto enveloped, auto flat, const float* gain)
+            {
+                if (unitStep)
+                    grain::kernel::renderUnitStep(blk.layout, src, samplePosition::wholeFrames(rp), envHere, gain, dst, n);
+                else if (envHere != nullptr)
+                    enveloped(src, rp, lvStep, envHere, gain, dst, n);
+                else
+                    flat(src, rp, lvStep, nullptr, gain, dst, n);
+            };
+
+        const int lastCh = std::min(1, blk.nSrcCh - 1);
+        if (blk.compact != nullptr)
+        {
+            // int16 frames: the level's scale rides on the gain
+            const CompactBuffer& frames = level > 0 ? blk.pyramid->getCompactLevel(level) : *blk.compact;
+            const int16_t* const src[2] = { frames.getReadPointer(0), frames.getReadPointer(lastCh) };
+            const float scaled[2] = { gains[0] * frames.getScale(), gains[1] * frames.getScale() };
+            mix(src, blk.kernel.enveloped16, blk.kernel.flat16, scaled);
+        }
+        else
+        {
+            const float* const src[2] = { level > 0 ? blk.pyramid->getReadPointer(level, 0) : blk.src->getReadPointer(0),
+                                          level > 0 ? blk.pyramid->getReadPointer(level, lastCh) : blk.src->getReadPointer(lastCh) };
+            mix(src, blk.kernel.enveloped, blk.kernel.flat, gains);
         }
 
-        outL[s] += mixL;
-        if (outR)
-            outR[s] += mixR;
+        done += n;
+        pool.envStageLeft[g] = left - n;
+        if (left == n)
+            grain::env::nextStage(pool, g);
     }
+
+    /* E. bookkeeping ------------------------------------------------ */
+    if (!audible)
+        grain::env::skip(pool, g, framesHere);
+
+    pool.samplePos[g] += step * static_cast<uint64_t>(framesHere);
+    pool.frames[g] -= framesHere;
+    pool.delay[g] = 0;
+    return !(pool.frames[g] <= 0 || pool.envStage[g] == GrainStage::Done
+             || samplePosition::wholeFrames(pool.samplePos[g]) >= blk.srcEnd);
 }
@@ -0,0 +1,468 @@
+// GrainRenderKernel.cpp – SIMD variants of the grain render loop -------------
+#include "GrainRenderKernel.h"
+#include <juce_core/juce_core.h>
+#include <cmath>
+#include <type_traits>
+
+#if RAIN_KERNEL_X86
+ #include <immintrin.h>
+ #if defined(__GNUC__) || defined(__clang__)
+  #define RAIN_TARGET_AVX2 __attribute__((target("avx2")))
+ #else
+  #define RAIN_TARGET_AVX2
+ #endif
+#endif
+
+#if RAIN_KERNEL_NEON
+ #include <arm_neon.h>
+#endif
+
+namespace grain::kernel
+{
+    /*──────────────────────────────────────────────────────────────────────
+      Sinc table – Blackman-windowed sinc, cutoff a little under Nyquist.
+      Tap k of phase p sits at distance (k - 3) - p / kSincPhases from the
+      read head; every phase is normalised to unity DC gain.
+    ──────────────────────────────────────────────────────────────────────*/
+    static void buildSincTable(SincTable& t) noexcept
+    {
+        constexpr double pi     = 3.14159265358979323846;
+        constexpr double cutoff = 0.94;                          // of Nyquist
+        constexpr double half   = kSincTaps / 2;
+
+        for (int p = 0; p <= kSincPhases; ++p)
+        {
+            const double frac = double(p) / double(kSincPhases);
+            double       sum  = 0.0;
+            double       h[kSincTaps];
+
+            for (int k = 0; k < kSincTaps; ++k)
+            {
+                const double x    = double(k - (kSincTaps / 2 - 1)) - frac;
+                const double arg  = pi * cutoff * x;
+                const double sinc = (x == 0.0) ? 1.0 : std::sin(arg) / arg;
+                const double w    = (std::abs(x) >= half) ? 0.0
+                                  : 0.42 + 0.5 * std::cos(pi * x / half) + 0.08 * std::cos(2.0 * pi * x / half);
+                h[k] = sinc * w;
+                sum += h[k];
+            }
+
+            for (int k = 0; k < kSincTaps; ++k)
+                t.coef[p][k] = float(h[k] / sum);
+        }
+    }
+
+    const SincTable& getSincTable() noexcept
+    {
+        static const SincTable table = []
+            {
+                SincTable t{};
+                buildSincTable(t);
+                return t;
+            }();
+        return table;
+    }
+
+#if RAIN_KERNEL_X86
+    /*──────────────────────────────────────────────────────────────────────
+      SSE2 – 4 frames / iteration. No gather, so the taps are loaded
+      through small stack arrays. Linear and Hermite only.
+    ──────────────────────────────────────────────────────────────────────*/
+    template <Interp I, typename T>
+    static inline __m128 sampleSSE2(const T* src, const int* idx, __m128 frac) noexcept
+    {
+        constexpr Support sup = supportOf(I);
+        constexpr int     numTaps = sup.before + sup.after + 1;
+
+        alignas(16) float x[numTaps][4];
+        for (int k = 0; k < numTaps; ++k)
+            for (int l = 0; l < 4; ++l)
+                x[k][l] = float(src[idx[l] + k - sup.before]);       // widens int16
+
+        if constexpr (I == Interp::Linear)
+        {
+            const __m128 va = _mm_load_ps(x[0]);
+            const __m128 vb = _mm_load_ps(x[1]);
+            return _mm_add_ps(va, _mm_mul_ps(frac, _mm_sub_ps(vb, va)));
+        }
+        else if constexpr (I == Interp::Hermite)
+        {
+            const __m128 xm1 = _mm_load_ps(x[0]), x0 = _mm_load_ps(x[1]);
+            const __m128 x1  = _mm_load_ps(x[2]), x2 = _mm_load_ps(x[3]);
+            const __m128 c1 = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_sub_ps(x1, xm1));
+            const __m128 c2 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(xm1, _mm_mul_ps(_mm_set1_ps(2.5f), x0)),
+                                                    _mm_mul_ps(_mm_set1_ps(2.0f), x1)),
+                                         _mm_mul_ps(_mm_set1_ps(0.5f), x2));
+            const __m128 c3 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.5f), _mm_sub_ps(x2, xm1)),
+                                         _mm_mul_ps(_mm_set1_ps(1.5f), _mm_sub_ps(x0, x1)));
+            __m128 y = _mm_add_ps(_mm_mul_ps(c3, frac), c2);
+            y = _mm_add_ps(_mm_mul_ps(y, frac), c1);
+            return _mm_add_ps(_mm_mul_ps(y, frac), x0);
+        }
+        else
+        {
+            // Sinc stays on the scalar loop for SSE2 (see getKernelFor):
+            // loading 8 taps + 16 coefficients lane by lane cost more than
+            // the 4-wide math saved.
+            static_assert(I != Interp::Sinc, "no SSE2 sinc kernel");
+            return _mm_setzero_ps();
+        }
+    }
+
+    template <Interp I, bool Enveloped, Layout L, typename T = float>
+    static void renderSSE2(const T* const* src, uint64_t readPos, uint64_t step,
+                           const float* env, const float* gain, float* const* dst,
+                           int numFrames) noexcept
+    {
+        constexpr int numIn = numInputs(L), numOut = numOutputs(L);
+
+        const __m128i four = _mm_set1_epi64x(static_cast<int64_t>(4 * step));
+        const __m128  fsc  = _mm_set1_ps(kFracScale);
+
+        __m128 g[numOut];
+        for (int o = 0; o < numOut; ++o)
+            g[o] = _mm_set1_ps(gain[o]);
+
+        // lanes hold readPos + s * step for s = 0, 1 and 2, 3
+        __m128i p01 = _mm_set_epi64x(static_cast<int64_t>(readPos + step), static_cast<int64_t>(readPos));
+        __m128i p23 = _mm_set_epi64x(static_cast<int64_t>(readPos + 3 * step),
+                                     static_cast<int64_t>(readPos + 2 * step));
+
+        alignas(16) int idx[4];
+
+        int s = 0;
+        for (; s + 4 <= numFrames; s += 4)
+        {
+            // high words → frame index, low words → fraction
+            const __m128i hi = _mm_unpacklo_epi64(_mm_shuffle_epi32(p01, _MM_SHUFFLE(3, 1, 3, 1)),
+                                                  _mm_shuffle_epi32(p23, _MM_SHUFFLE(3, 1, 3, 1)));
+            const __m128i lo = _mm_unpacklo_epi64(_mm_shuffle_epi32(p01, _MM_SHUFFLE(2, 0, 2, 0)),
+                                                  _mm_shuffle_epi32(p23, _MM_SHUFFLE(2, 0, 2, 0)));
+            const __m128  frac = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(lo, kFracShift)), fsc);
+
+            _mm_store_si128(reinterpret_cast<__m128i*>(idx), hi);
+
+            __m128 samp[numIn];
+            for (int c = 0; c < numIn; ++c)
+                samp[c] = sampleSSE2<I>(src[c], idx, frac);
+
+            for (int o = 0; o < numOut; ++o)
+            {
+                const __m128 amp = Enveloped ? _mm_mul_ps(g[o], _mm_loadu_ps(env + s)) : g[o];
+                _mm_storeu_ps(dst[o] + s, _mm_add_ps(_mm_loadu_ps(dst[o] + s),
+                                                     _mm_mul_ps(amp, samp[numIn == 1 ? 0 : o])));
+            }
+
+            p01 = _mm_add_epi64(p01, four);
+            p23 = _mm_add_epi64(p23, four);
+        }
+
+        renderScalarRange<I, Enveloped, L, T>(src, readPos, step, env, gain, dst, s, numFrames);
+    }
+
+    /*──────────────────────────────────────────────────────────────────────
+      AVX2 – 8 frames / iteration, hardware gather for every tap. int16
+      frames are gathered as 32-bit words at 2-byte scale (the word's low
+      half is the frame), then sign-extended and converted.
+    ──────────────────────────────────────────────────────────────────────*/
+    template <Interp I, typename T>
+    RAIN_TARGET_AVX2
+    static inline __m256 sampleAVX2(const T* src, __m256i idx, __m256 frac,
+                                    const float* sinc) noexcept
+    {
+        const auto tap = [&](int k) RAIN_TARGET_AVX2
+            {
+                const __m256i at = _mm256_add_epi32(idx, _mm256_set1_epi32(k));
+                if constexpr (std::is_same_v<T, float>)
+                {
+                    return _mm256_i32gather_ps(src, at, 4);
+                }
+                else
+                {
+                    const __m256i w = _mm256_i32gather_epi32(reinterpret_cast<const int*>(src), at, 2);
+                    return _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(w, 16), 16));
+                }
+            };
+
+        if constexpr (I == Interp::Linear)
+        {
+            const __m256 va = tap(0);
+            const __m256 vb = tap(1);
+            return _mm256_add_ps(va, _mm256_mul_ps(frac, _mm256_sub_ps(vb, va)));
+        }
+        else if constexpr (I == Interp::Hermite)
+        {
+            const __m256 xm1 = tap(-1), x0 = tap(0), x1 = tap(1), x2 = tap(2);
+            const __m256 c1 = _mm256_mul_ps(_mm256_set1_ps(0.5f), _mm256_sub_ps(x1, xm1));
+            const __m256 c2 = _mm256_sub_ps(_mm256_add_ps(_mm256_sub_ps(xm1, _mm256_mul_ps(_mm256_set1_ps(2.5f), x0)),
+                                                          _mm256_mul_ps(_mm256_set1_ps(2.0f), x1)),
+                                            _mm256_mul_ps(_mm256_set1_ps(0.5f), x2));
+            const __m256 c3 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), _mm256_sub_ps(x2, xm1)),
+                                            _mm256_mul_ps(_mm256_set1_ps(1.5f), _mm256_sub_ps(x0, x1)));
+            __m256 y = _mm256_add_ps(_mm256_mul_ps(c3, frac), c2);
+            y = _mm256_add_ps(_mm256_mul_ps(y, frac), c1);
+            return _mm256_add_ps(_mm256_mul_ps(y, frac), x0);
+        }
+        else
+        {
+            const __m256  pf   = _mm256_mul_ps(frac, _mm256_set1_ps(float(kSincPhases)));
+            const __m256i pi   = _mm256_min_epi32(_mm256_cvttps_epi32(pf), _mm256_set1_epi32(kSincPhases - 1));
+            const __m256  pt   = _mm256_sub_ps(pf, _mm256_cvtepi32_ps(pi));
+            const __m256i row  = _mm256_slli_epi32(pi, 3);                    // p * kSincTaps
+            static_assert(kSincTaps == 8, "row index shift assumes 8 taps");
+
+            __m256 acc = _mm256_setzero_ps();
+            for (int k = 0; k < kSincTaps; ++k)
+            {
+                const __m256 ca = _mm256_i32gather_ps(sinc + k,             row, 4);
+                const __m256 cb = _mm256_i32gather_ps(sinc + kSincTaps + k, row, 4);
+                const __m256 c  = _mm256_add_ps(ca, _mm256_mul_ps(pt, _mm256_sub_ps(cb, ca)));
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(c, tap(k - (kSincTaps / 2 - 1))));
+            }
+            return acc;
+        }
+    }
+
+    template <Interp I, bool Enveloped, Layout L, typename T = float>
+    RAIN_TARGET_AVX2
+    static void renderAVX2(const T* const* src, uint64_t readPos, uint64_t step,
+                           const float* env, const float* gain, float* const* dst,
+                           int numFrames) noexcept
+    {
+        constexpr int numIn = numInputs(L), numOut = numOutputs(L);
+        const float*  sinc = (I == Interp::Sinc) ? getSincTable().coef[0] : nullptr;
+
+        const __m256i eight = _mm256_set1_epi64x(static_cast<int64_t>(8 * step));
+        const __m256i odds  = _mm256_setr_epi32(1, 3, 5, 7, 0, 2, 4, 6);     // high words first
+        const __m256  fsc   = _mm256_set1_ps(kFracScale);
+
+        __m256 g[numOut];
+        for (int o = 0; o < numOut; ++o)
+            g[o] = _mm256_set1_ps(gain[o]);
+
+        // lanes hold readPos + s * step for s = 0 … 3 and 4 … 7
+        const auto at = [=](uint64_t k) { return static_cast<int64_t>(readPos + k * step); };
+        __m256i pLo = _mm256_setr_epi64x(at(0), at(1), at(2), at(3));
+        __m256i pHi = _mm256_setr_epi64x(at(4), at(5), at(6), at(7));
+
+        int s = 0;
+        for (; s + 8 <= numFrames; s += 8)
+        {
+            const __m256i a = _mm256_permutevar8x32_epi32(pLo, odds);
+            const __m256i b = _mm256_permutevar8x32_epi32(pHi, odds);
+
+            const __m256i idx  = _mm256_permute2x128_si256(a, b, 0x20);      // high words, s order
+            const __m256i lo   = _mm256_permute2x128_si256(a, b, 0x31);      // low words, s order
+            const __m256  frac = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(lo, kFracShift)), fsc);
+
+            __m256 samp[numIn];
+            for (int c = 0; c < numIn; ++c)
+                samp[c] = sampleAVX2<I>(src[c], idx, frac, sinc);
+
+            for (int o = 0; o < numOut; ++o)
+            {
+                const __m256 amp = Enveloped ? _mm256_mul_ps(g[o], _mm256_loadu_ps(env + s)) : g[o];
+                _mm256_storeu_ps(dst[o] + s, _mm256_add_ps(_mm256_loadu_ps(dst[o] + s),
+                                                           _mm256_mul_ps(amp, samp[numIn == 1 ? 0 : o])));
+            }
+
+            pLo = _mm256_add_epi64(pLo, eight);
+            pHi = _mm256_add_epi64(pHi, eight);
+        }
+
+        renderScalarRange<I, Enveloped, L, T>(src, readPos, step, env, gain, dst, s, numFrames);
+    }
+#endif
+
+#if RAIN_KERNEL_NEON
+    /*──────────────────────────────────────────────────────────────────────
+      NEON (AArch64) – 4 frames / iteration, uint64x2 fixed-point read head
+    ──────────────────────────────────────────────────────────────────────*/
+    template <Interp I, typename T>
+    static inline float32x4_t sampleNEON(const T* src, const int32_t* idx, float32x4_t frac,
+                                         const float* sinc) noexcept
+    {
+        constexpr Support sup = supportOf(I);
+        constexpr int     numTaps = sup.before + sup.after + 1;
+
+        alignas(16) float x[numTaps][4];
+        for (int k = 0; k < numTaps; ++k)
+            for (int l = 0; l < 4; ++l)
+                x[k][l] = float(src[idx[l] + k - sup.before]);       // widens int16
+
+        if constexpr (I == Interp::Linear)
+        {
+            const float32x4_t va = vld1q_f32(x[0]);
+            const float32x4_t vb = vld1q_f32(x[1]);
+            return vaddq_f32(va, vmulq_f32(frac, vsubq_f32(vb, va)));
+        }
+        else if constexpr (I == Interp::Hermite)
+        {
+            const float32x4_t xm1 = vld1q_f32(x[0]), x0 = vld1q_f32(x[1]);
+            const float32x4_t x1  = vld1q_f32(x[2]), x2 = vld1q_f32(x[3]);
+            const float32x4_t c1 = vmulq_f32(vdupq_n_f32(0.5f), vsubq_f32(x1, xm1));
+            const float32x4_t c2 = vsubq_f32(vaddq_f32(vsubq_f32(xm1, vmulq_f32(vdupq_n_f32(2.5f), x0)),
+                                                       vmulq_f32(vdupq_n_f32(2.0f), x1)),
+                                             vmulq_f32(vdupq_n_f32(0.5f), x2));
+            const float32x4_t c3 = vaddq_f32(vmulq_f32(vdupq_n_f32(0.5f), vsubq_f32(x2, xm1)),
+                                             vmulq_f32(vdupq_n_f32(1.5f), vsubq_f32(x0, x1)));
+            float32x4_t y = vaddq_f32(vmulq_f32(c3, frac), c2);
+            y = vaddq_f32(vmulq_f32(y, frac), c1);
+            return vaddq_f32(vmulq_f32(y, frac), x0);
+        }
+        else
+        {
+            const float32x4_t pf = vmulq_f32(frac, vdupq_n_f32(float(kSincPhases)));
+            const int32x4_t   pi = vminq_s32(vcvtq_s32_f32(pf), vdupq_n_s32(kSincPhases - 1));
+            const float32x4_t pt = vsubq_f32(pf, vcvtq_f32_s32(pi));
+
+            alignas(16) int32_t p[4];
+            vst1q_s32(p, vshlq_n_s32(pi, 3));                                 // p * kSincTaps
+
+            float32x4_t acc = vdupq_n_f32(0.0f);
+            for (int k = 0; k < kSincTaps; ++k)
+            {
+                alignas(16) float a[4], b[4];
+                for (int l = 0; l < 4; ++l)
+                {
+                    a[l] = sinc[p[l] + k];
+                    b[l] = sinc[p[l] + kSincTaps + k];
+                }
+                const float32x4_t ca = vld1q_f32(a);
+                const float32x4_t c  = vaddq_f32(ca, vmulq_f32(pt, vsubq_f32(vld1q_f32(b), ca)));
+                acc = vaddq_f32(acc, vmulq_f32(c, vld1q_f32(x[k])));
+            }
+            return acc;
+        }
+    }
+
+    template <Interp I, bool Enveloped, Layout L, typename T = float>
+    static void renderNEON(const T* const* src, uint64_t readPos, uint64_t step,
+                           const float* env, const float* gain, float* const* dst,
+                           int numFrames) noexcept
+    {
+        constexpr int numIn = numInputs(L), numOut = numOutputs(L);
+        const float*  sinc = (I == Interp::Sinc) ? getSincTable().coef[0] : nullptr;
+
+        const uint64x2_t four = vdupq_n_u64(4 * step);
+
+        float32x4_t g[numOut];
+        for (int o = 0; o < numOut; ++o)
+            g[o] = vdupq_n_f32(gain[o]);
+
+        // lanes hold readPos + s * step for s = 0, 1 and 2, 3
+        const uint64_t k01[2] = { readPos, readPos + step };
+        const uint64_t k23[2] = { readPos + 2 * step, readPos + 3 * step };
+        uint64x2_t p01 = vld1q_u64(k01);
+        uint64x2_t p23 = vld1q_u64(k23);
+
+        alignas(16) int32_t idx[4];
+
+        int s = 0;
+        for (; s + 4 <= numFrames; s += 4)
+        {
+            // high words → frame index, low words → fraction
+            const uint32x4_t hi = vcombine_u32(vshrn_n_u64(p01, 32), vshrn_n_u64(p23, 32));
+            const uint32x4_t lo = vcombine_u32(vmovn_u64(p01), vmovn_u64(p23));
+            const float32x4_t frac = vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(lo, kFracShift)), kFracScale);
+
+            vst1q_s32(idx, vreinterpretq_s32_u32(hi));
+
+            float32x4_t samp[numIn];
+            for (int c = 0; c < numIn; ++c)
+                samp[c] = sampleNEON<I>(src[c], idx, frac, sinc);
+
+            for (int o = 0; o < numOut; ++o)
+            {
+                const float32x4_t amp = Enveloped ? vmulq_f32(g[o], vld1q_f32(env + s)) : g[o];
+                vst1q_f32(dst[o] + s, vaddq_f32(vld1q_f32(dst[o] + s),
+                                                vmulq_f32(amp, samp[numIn == 1 ? 0 : o])));
+            }
+
+            p01 = vaddq_u64(p01, four);
+            p23 = vaddq_u64(p23, four);
+        }
+
+        renderScalarRange<I, Enveloped, L, T>(src, readPos, step, env, gain, dst, s, numFrames);
+    }
+#endif
+
+    /*──────────────────────────────────────────────────────────────────────
+      Dispatch
+    ──────────────────────────────────────────────────────────────────────*/
+    Isa detectIsa() noexcept
+    {
+#if RAIN_KERNEL_X86
+        if (juce::SystemStats::hasAVX2())
+            return Isa::AVX2;
+        if (juce::SystemStats::hasSSE2())
+            return Isa::SSE2;
+#elif RAIN_KERNEL_NEON
+        return Isa::NEON;
+#endif
+        return Isa::Scalar;
+    }
+
+    template <Interp I, Layout L>
+    static Kernel getKernelFor(Isa isa) noexcept
+    {
+        switch (isa)
+        {
+#if RAIN_KERNEL_X86
+        case Isa::AVX2:
+            if (juce::SystemStats::hasAVX2())
+                return { renderAVX2<I, true, L>, renderAVX2<I, false, L>,
+                         renderAVX2<I, true, L, int16_t>, renderAVX2<I, false, L, int16_t> };
+            [[fallthrough]];
+        case Isa::SSE2:
+            if constexpr (I != Interp::Sinc)
+                if (juce::SystemStats::hasSSE2())
+                    return { renderSSE2<I, true, L>, renderSSE2<I, false, L>,
+                             renderSSE2<I, true, L, int16_t>, renderSSE2<I, false, L, int16_t> };
+            break;
+#endif
+#if RAIN_KERNEL_NEON
+        case Isa::NEON:
+            return { renderNEON<I, true, L>, renderNEON<I, false, L>,
+                     renderNEON<I, true, L, int16_t>, renderNEON<I, false, L, int16_t> };
+#endif
+        default:
+            break;
+        }
+
+        return { renderScalar<I, true, L>, renderScalar<I, false, L>,
+                 renderScalar<I, true, L, int16_t>, renderScalar<I, false, L, int16_t> };
+    }
+
+    template <Interp I>
+    static Kernel getKernelFor(Isa isa, Layout layout) noexcept
+    {
+        switch (layout)
+        {
+        case Layout::MonoToStereo: return getKernelFor<I, Layout::MonoToStereo>(isa);
+        case Layout::Stereo:       return getKernelFor<I, Layout::Stereo>(isa);
+        default:                   return getKernelFor<I, Layout::Mono>(isa);
+        }
+    }
+
+    Kernel getKernel(Isa isa, Interp interp, Layout layout) noexcept
+    {
+        switch (interp)
+        {
+        case Interp::Hermite: return getKernelFor<Interp::Hermite>(isa, layout);
+        case Interp::Sinc:    return getKernelFor<Interp::Sinc>(isa, layout);
+        default:              return getKernelFor<Interp::Linear>(isa, layout);
+        }
+    }
+
+    const char* getIsaName(Isa isa) noexcept
+    {
+        switch (isa)
+        {
+        case Isa::SSE2: return "SSE2";
+        case Isa::AVX2: return "AVX2";
+        case Isa::NEON: return "NEON";
+        default:        return "Scalar";
+        }
+    }
+}
@@ -0,0 +1,288 @@
+/*==============================================================================
+   GrainRenderKernel.h  – inner sample loop of GrainProcessor PASS 1
+
+   dst[o][s] += gain[o] * env[s] * interp(src[c], readPos + s * step)    s ∈ [0, n)
+
+   The "flat" variant drops env[s] (sustain segment: a scaled copy-add).
+   The "16" variants read int16 frames (CompactBuffer) and widen them to
+   float in registers; the caller folds the buffer scale into gain.
+
+   The channel Layout says which source channel c feeds output o: Mono
+   (1 → 1), MonoToStereo (1 → 2, each frame read and interpolated once,
+   then written to both outputs) or Stereo (2 → 2 on one shared read head).
+
+   interp and layout are picked per block (Linear / 4-point Hermite / 8-tap
+   polyphase sinc). Every (ISA, interp, layout, envelope, sample type)
+   combination is its own template instantiation, so the hot loop never
+   branches on any of them.
+
+   readPos and step are 32.32 fixed point (samplePosition::Fixed): the frame
+   index is the high word, the fraction the top 24 bits of the low word. Both
+   come out with shifts and masks, and integer adds make the head exact.
+
+   The scalar version is the reference implementation. SIMD versions live in
+   GrainRenderKernel.cpp and are picked once at runtime; they compute the read
+   head the same way (exact integer adds) and combine taps in the same order,
+   so every path produces bit-identical output.
+==============================================================================*/
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define RAIN_KERNEL_X86  1
+#else
+ #define RAIN_KERNEL_X86  0
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+ #define RAIN_KERNEL_NEON 1
+#else
+ #define RAIN_KERNEL_NEON 0
+#endif
+
+#if RAIN_KERNEL_X86 && !(defined(__GNUC__) || defined(__clang__))
+ #include <xmmintrin.h>                                 // _mm_prefetch
+#endif
+
+namespace grain::kernel
+{
+    enum class Isa : uint8_t { Scalar, SSE2, AVX2, NEON };
+
+    enum class Interp : uint8_t
+    {
+        Linear,      // 2 taps
+        Hermite,     // 4-point, 3rd order
+        Sinc,        // 8-tap windowed sinc, polyphase
+        Count
+    };
+
+    enum class Layout : uint8_t
+    {
+        Mono,           // source channel 0 → one output
+        MonoToStereo,   // source channel 0 → two outputs
+        Stereo,         // source channels 0, 1 → outputs 0, 1
+        Count
+    };
+
+    inline constexpr int numInputs(Layout l) noexcept  { return l == Layout::Stereo ? 2 : 1; }
+    inline constexpr int numOutputs(Layout l) noexcept { return l == Layout::Mono ? 1 : 2; }
+
+    /* Channels past the first two are neither read nor written */
+    inline constexpr Layout layoutFor(int numSrcCh, int numOutCh) noexcept
+    {
+        if (numOutCh < 2)
+            return Layout::Mono;
+        return numSrcCh < 2 ? Layout::MonoToStereo : Layout::Stereo;
+    }
+
+    /* Source frames read around the head's whole frame idx: [idx - before, idx + after] */
+    struct Support { int before, after; };
+
+    inline constexpr int kSincTaps   = 8;
+    inline constexpr int kSincPhases = 256;            // coefficients lerped between phases
+
+    inline constexpr Support supportOf(Interp interp) noexcept
+    {
+        switch (interp)
+        {
+        case Interp::Hermite: return { 1, 2 };
+        case Interp::Sinc:    return { kSincTaps / 2 - 1, kSincTaps / 2 };
+        default:              return { 0, 1 };
+        }
+    }
+
+    inline constexpr Support kMaxSupport = supportOf(Interp::Sinc);   // widest of all
+
+    inline constexpr int   kFracShift = 8;                  // low word → 24-bit fraction
+    inline constexpr float kFracScale = 1.0f / 16777216.0f; // 2^-24
+
+    inline int indexOf(uint64_t pos) noexcept
+    {
+        return static_cast<int>(pos >> 32);
+    }
+
+    inline float fracOf(uint64_t pos) noexcept              // exact in float
+    {
+        return float(static_cast<uint32_t>(pos) >> kFracShift) * kFracScale;
+    }
+
+    /* kSincPhases + 1 rows so phase p + 1 always exists; each row sums to 1 */
+    struct SincTable
+    {
+        alignas(32) float coef[kSincPhases + 1][kSincTaps];
+    };
+
+    /* Built on first call (thread-safe static); GrainEngine warms it up */
+    const SincTable& getSincTable() noexcept;
+
+    template <typename T>
+    using RenderFnT = void (*)(const T* const* src,      // numInputs(layout) channels
+                               uint64_t        readPos,
+                               uint64_t        step,
+                               const float*    env,
+                               const float*    gain,     // numOutputs(layout) gains
+                               float* const*   dst,      // numOutputs(layout) channels
+                               int             numFrames) noexcept;
+
+    using RenderFn   = RenderFnT<float>;
+    using RenderFn16 = RenderFnT<int16_t>;
+
+    struct Kernel
+    {
+        RenderFn   enveloped;       // uses env[s]
+        RenderFn   flat;            // ignores env, may be passed nullptr
+        RenderFn16 enveloped16;     // same pair on int16 frames
+        RenderFn16 flat16;
+    };
+
+    /*--------------------------------------------------------------------
+        One interpolated source sample – shared by every scalar path
+    --------------------------------------------------------------------*/
+    template <Interp I, typename T>
+    inline float interpolate(const T* src, int idx, float frac, const float* sinc) noexcept
+    {
+        if constexpr (I == Interp::Linear)
+        {
+            const float a = float(src[idx]), b = float(src[idx + 1]);
+            return a + frac * (b - a);
+        }
+        else if constexpr (I == Interp::Hermite)
+        {
+            const float xm1 = float(src[idx - 1]), x0 = float(src[idx]);
+            const float x1  = float(src[idx + 1]), x2 = float(src[idx + 2]);
+            const float c1 = 0.5f * (x1 - xm1);
+            const float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+            const float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+            return ((c3 * frac + c2) * frac + c1) * frac + x0;
+        }
+        else
+        {
+            const float  pf = frac * float(kSincPhases);
+            const int    p  = std::min(int(pf), kSincPhases - 1);
+            const float  pt = pf - float(p);
+            const float* c0 = sinc + p * kSincTaps;
+            const float* c1 = c0 + kSincTaps;
+            const T*     x  = src + idx - (kSincTaps / 2 - 1);
+
+            float acc = 0.0f;
+            for (int k = 0; k < kSincTaps; ++k)
+                acc = acc + (c0[k] + pt * (c1[k] - c0[k])) * float(x[k]);
+            return acc;
+        }
+    }
+
+    /*--------------------------------------------------------------------
+        Scalar reference – also used for the tail of the SIMD loops
+    --------------------------------------------------------------------*/
+    template <Interp I, bool Enveloped, Layout L, typename T = float>
+    inline void renderScalarRange(const T* const* src, uint64_t readPos, uint64_t step,
+                                  const float* env, const float* gain, float* const* dst,
+                                  int begin, int end) noexcept
+    {
+        constexpr int numIn = numInputs(L), numOut = numOutputs(L);
+        const float*  sinc = (I == Interp::Sinc) ? getSincTable().coef[0] : nullptr;
+
+        for (int s = begin; s < end; ++s)
+        {
+            const uint64_t rp  = readPos + static_cast<uint64_t>(s) * step;
+            const int      idx = indexOf(rp);
+            const float    frac = fracOf(rp);
+
+            float samp[numIn];
+            for (int c = 0; c < numIn; ++c)
+                samp[c] = interpolate<I>(src[c], idx, frac, sinc);
+
+            for (int o = 0; o < numOut; ++o)
+            {
+                if constexpr (Enveloped)
+                    dst[o][s] += gain[o] * env[s] * samp[numIn == 1 ? 0 : o];
+                else
+                    dst[o][s] += gain[o] * samp[numIn == 1 ? 0 : o];
+            }
+        }
+    }
+
+    template <Interp I, bool Enveloped, Layout L, typename T = float>
+    inline void renderScalar(const T* const* src, uint64_t readPos, uint64_t step,
+                             const float* env, const float* gain, float* const* dst,
+                             int numFrames) noexcept
+    {
+        renderScalarRange<I, Enveloped, L, T>(src, readPos, step, env, gain, dst, 0, numFrames);
+    }
+
+    inline constexpr Kernel kScalarKernel { renderScalar<Interp::Linear, true, Layout::Mono>,
+                                            renderScalar<Interp::Linear, false, Layout::Mono>,
+                                            renderScalar<Interp::Linear, true, Layout::Mono, int16_t>,
+                                            renderScalar<Interp::Linear, false, Layout::Mono, int16_t> };
+
+    /*--------------------------------------------------------------------
+        Step 1 from a whole frame – frac is 0 on every sample, so each
+        interpolator reduces to src[s] (Linear and Hermite exactly, sinc
+        up to its phase-0 row). The loop is a plain copy-and-scale.
+    --------------------------------------------------------------------*/
+    template <bool Enveloped, Layout L, typename T>
+    inline void renderUnitStep(const T* const* src, int first, const float* env,
+                               const float* gain, float* const* dst, int numFrames) noexcept
+    {
+        constexpr int numIn = numInputs(L), numOut = numOutputs(L);
+
+        for (int s = 0; s < numFrames; ++s)
+        {
+            float x[numIn];
+            for (int c = 0; c < numIn; ++c)
+                x[c] = float(src[c][first + s]);
+
+            for (int o = 0; o < numOut; ++o)
+            {
+                if constexpr (Enveloped)
+                    dst[o][s] += gain[o] * env[s] * x[numIn == 1 ? 0 : o];
+                else
+                    dst[o][s] += gain[o] * x[numIn == 1 ? 0 : o];
+            }
+        }
+    }
+
+    /* Same, picking the layout and envelope at run time (env null: flat) */
+    template <typename T>
+    inline void renderUnitStep(Layout layout, const T* const* src, int first, const float* env,
+                               const float* gain, float* const* dst, int numFrames) noexcept
+    {
+        const auto run = [&](auto layoutTag)
+            {
+                constexpr Layout L = decltype(layoutTag)::value;
+                if (env != nullptr)
+                    renderUnitStep<true, L>(src, first, env, gain, dst, numFrames);
+                else
+                    renderUnitStep<false, L>(src, first, nullptr, gain, dst, numFrames);
+            };
+
+        switch (layout)
+        {
+        case Layout::MonoToStereo: run(std::integral_constant<Layout, Layout::MonoToStereo>{}); break;
+        case Layout::Stereo:       run(std::integral_constant<Layout, Layout::Stereo>{});       break;
+        default:                   run(std::integral_constant<Layout, Layout::Mono>{});         break;
+        }
+    }
+
+    /* Hint that p will be read soon; no-op where unsupported */
+    inline void prefetch(const void* p) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(p, 0, 1);
+#elif RAIN_KERNEL_X86
+        _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T1);
+#else
+        (void) p;
+#endif
+    }
+
+    /*--------------------------------------------------------------------
+        Dispatch – call once (prepare), keep the result
+    --------------------------------------------------------------------*/
+    Isa         detectIsa() noexcept;                 // best ISA on this CPU
+    Kernel      getKernel(Isa isa, Interp interp = Interp::Linear,
+                          Layout layout = Layout::Mono) noexcept;          // falls back to scalar
+    const char* getIsaName(Isa isa) noexcept;
+}
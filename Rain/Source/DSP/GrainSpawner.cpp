@@ -1,15 +1,34 @@
 // GrainSpawner.cpp – implementation -------------------------------------------
 #include "GrainSpawner.h"
 #include "VoiceEnvelope.h"
+#include "GrainEnvelope.h"
 #include "../Parameters/ParameterIDs.h"
 #include "SamplePosition.h"
+#include "GrainRenderKernel.h"
+#include "RatioTable.h"
 
-void GrainSpawner::prepare(double sampleRate, int maxBlockSize)
+void GrainSpawner::prepare(double sampleRate, int maxBlockSize, std::size_t grainCapacity)
 {
 	this->sampleRate = sampleRate;
 	this->maxBlockSize = maxBlockSize;
 
     voices.clear();
+
+    queuedSlot.assign(grainCapacity, 0);
+    queuedVoice.assign(grainCapacity, 0);
+    queuedOffset.assign(grainCapacity, 0);
+    numQueued = 0;
+    hasSnapShot = false;                                  // first block starts from its own values
+
+    // Same seed, same stream: a render from prepare is reproducible
+    const uint64_t seed = randomSeed != 0 ? randomSeed : instanceSeed;
+    rng.seed(seed);
+    onsetRng.seed(seed + 1);                              // its own stream, so onsets don't shift the fields
+}
+
+void GrainSpawner::setRandomSeed(uint64_t seed) noexcept
+{
+    randomSeed = seed;
 }
 
 void GrainSpawner::setParameterBank(const ParameterBank* params) noexcept
@@ -33,31 +52,61 @@ inline bool shouldPlayRoot(const ParameterBank& p, PlayMode mode) noexcept
 }
 
 // ────────────────────────────────────────────────────────────────
-// Entry point – called once per audio block
-void GrainSpawner::processMidi(const juce::MidiBuffer& midi,
-    GrainPool& pool)
+// Start of a host block of numSamples frames – parameters and root gate
+void GrainSpawner::beginBlock(int numSamples)
 {
 	TRACE_DSP();
 
+    blockLength = numSamples;
+    subBlockStart = 0;
+    currentSampleOffset = 0;
+
+	// Take a snapshot of the current parameters for fast thread safe use. The
+	// block ramps from the previous snapshot to this one, so automation moves
+	// per grain instead of stepping at block boundaries.
+	const ParameterSnapshot target = loadSampleSnapShot();
+	const VoiceParameterSnapshot voiceTarget = loadVoiceSnapShot();
+	blockStart = hasSnapShot ? snapShot : target;
+	voiceBlockStart = hasSnapShot ? voiceSnapShot : voiceTarget;
+	snapShot = target;
+	voiceSnapShot = voiceTarget;
+	hasSnapShot = true;
+	rampsActive = !(blockStart == snapShot);
+
     const PlayMode mode = static_cast<PlayMode>(params->get(ParamID::ID::playMode));
-    const bool     root = (mode != PlayMode::Midi);
-    const bool     gate = shouldPlayRoot(*params, mode);
+    rootMode = (mode != PlayMode::Midi);
+    updateRootGate(shouldPlayRoot(*params, mode));
+}
 
-    updateRootGate(gate);
+// ────────────────────────────────────────────────────────────────
+// One sub-block [startSample, startSample + numSamples) of the host block.
+// Takes the MIDI events inside it; the last sub-block also takes any
+// events past the end of the block.
+void GrainSpawner::processMidi(const juce::MidiBuffer& midi, GrainPool& pool,
+    int startSample, int numSamples)
+{
+	TRACE_DSP();
 
+    subBlockStart = startSample;
     currentSampleOffset = 0;
-	snapShot = loadSampleSnapShot(); // Take a snapshot of the current parameters for fast thread safe use
-    voiceSnapShot = loadVoiceSnapShot();
+    poolExhausted = false;
+
+    const int  end = startSample + numSamples;
+    const bool last = end >= blockLength;
 
     // Walk MIDI events in ascending order
-    for (const auto meta : midi)
+    for (auto it = midi.findNextSamplePosition(startSample); it != midi.end(); ++it)
     {
-        const int pos = meta.samplePosition;
+        const auto meta = *it;
+        if (meta.samplePosition >= end && !last)
+            break;
+
+        const int pos = std::min(meta.samplePosition - startSample, numSamples);
         advanceTime(pos - currentSampleOffset, pool);
         currentSampleOffset = pos;
 
         const auto msg = meta.getMessage();
-        if (root)
+        if (rootMode)
         {
             if (msg.isNoteOff()) handleNoteOff(msg.getNoteNumber());
         }
@@ -68,8 +117,15 @@ void GrainSpawner::processMidi(const juce::MidiBuffer& midi,
         }
     }
 
-    // Finish the tail of the block
-    advanceTime(maxBlockSize - currentSampleOffset, pool);
+    // Finish the tail of the sub-block
+    advanceTime(numSamples - currentSampleOffset, pool);
+    spawnQueued(pool);
+
+    if (blockDropped != 0)
+        visualData.grainsDropped.fetch_add(blockDropped, std::memory_order_relaxed);
+    if (blockStolen != 0)
+        visualData.grainsStolen.fetch_add(blockStolen, std::memory_order_relaxed);
+    blockDropped = blockStolen = 0;
 }
 
 void GrainSpawner::updateRootGate(bool playRootNow)
@@ -97,12 +153,19 @@ void GrainSpawner::setSample(const LoadedSample* source)
 }
 
 // ────────────────────────────────────────────────────────────────
-// Move time forward and drop grains for every active voice
+// Move time forward and queue the onsets of every active voice
 void GrainSpawner::advanceTime(int numSamples, GrainPool& pool)
 {
     if (numSamples <= 0) return;
 
-	const float grainsPerSec = sampleRate / (params->get(ParamID::ID::grainRate));
+    // Frames between onsets (the mean gap in Poisson mode), at `at` frames into the span
+    const ParamRamp rate = rampOf(&ParameterSnapshot::grainRate);
+    const auto intervalAt = [&](double at)
+    {
+        return std::max(sampleRate / rate.at(subBlockStart + currentSampleOffset + static_cast<int>(at)),
+                        grain::schedule::kMinInterval);
+    };
+    const double interval = intervalAt(0.0);
 
     for (std::size_t v = 0; v < VoicePool::kMaxVoices; ++v)
     {
@@ -110,20 +173,164 @@ void GrainSpawner::advanceTime(int numSamples, GrainPool& pool)
 
         double cursor = voices.spawnCursor[v];           // position of next grain
 
-        while (cursor < numSamples)
+        if (spawnMode == grain::schedule::Mode::Poisson)
+        {
+            while (cursor < numSamples && queueOnset(pool, static_cast<int>(v), cursor))
+                cursor += grain::schedule::poissonGap(onsetRng.next(), intervalAt(cursor));
+
+            if (cursor < numSamples)                      // pool full: skip the rest of the span
+            {
+                // the onset at cursor, plus the expected count after it
+                blockDropped += static_cast<uint64_t>(
+                    1 + grain::schedule::expectedOnsets(numSamples - cursor, intervalAt(0.5 * (cursor + numSamples))));
+                cursor = numSamples + grain::schedule::poissonGap(onsetRng.next(), intervalAt(numSamples));
+            }
+        }
+        else if (rate.moving())
+        {
+            // Density is ramping: each gap uses the rate where it starts. One
+            // step per queued onset; a full pool skips the rest at the mean gap.
+            while (cursor < numSamples && queueOnset(pool, static_cast<int>(v), cursor))
+                cursor += intervalAt(cursor);
+
+            if (cursor < numSamples)
+            {
+                const double rest = intervalAt(0.5 * (cursor + numSamples));
+                const int    count = grain::schedule::countPeriodic(cursor, rest, numSamples);
+                blockDropped += static_cast<uint64_t>(count);
+                cursor += count * rest;
+            }
+        }
+        else
+        {
+            const int count = grain::schedule::countPeriodic(cursor, interval, numSamples);
+            int queued = 0;
+            while (queued < count && queueOnset(pool, static_cast<int>(v), cursor + queued * interval))
+                ++queued;
+
+            blockDropped += static_cast<uint64_t>(count - queued);
+            cursor += count * interval;
+        }
+
+        voices.spawnCursor[v] = static_cast<float>(cursor - numSamples);   // spill-over into next block
+    }
+}
+
+// Queue one onset `at` frames into the span; false once the pool is full.
+// Nothing is released while spawning, so after the first miss the rest of
+// the block is skipped without touching the pool.
+bool GrainSpawner::queueOnset(GrainPool& pool, int voice, double at)
+{
+    if (poolExhausted)
+        return false;
+
+    // Pick a free slot (overflowPolicy decides when the pool is full)
+    const int index = acquireGrain(pool);
+    if (index < 0)
+    {
+        poolExhausted = true;
+        return false;
+    }
+
+    queueGrain(index, voice, currentSampleOffset + static_cast<int>(at));   // sample-accurate start
+    return true;
+}
+
+// ────────────────────────────────────────────────────────────────
+// Overflow – a free slot for the next grain, or -1 if it is dropped (the
+// caller counts drops)
+int GrainSpawner::acquireGrain(GrainPool& pool)
+{
+    if (overflowPolicy == OverflowPolicy::DropNewest)
+    {
+        return pool.acquire();
+    }
+
+    // The victim keeps its slot until its fade ends, so the new grain
+    // takes one of the reserved slots meanwhile.
+    int index = pool.acquire(static_cast<int>(pool.getCapacity() >> kStealReserveShift));
+    if (index >= 0)
+        return index;
+
+    // A pool held mostly by grains still waiting on their start delay
+    // would only trade sounding grains for later ones: drop instead.
+    const int victim = pool.numPending > pool.numActive ? -1 : findVictim(pool);
+    if (victim >= 0)
+        index = pool.acquire();
+
+    if (index < 0)
+        return -1;                                        // reserve used up too
+
+    grain::env::fadeOut(pool, static_cast<std::size_t>(victim),
+                        static_cast<int>(kStealFadeSeconds * sampleRate + 0.5));
+    ++blockStolen;
+    return index;
+}
+
+// One linear pass over the live grains; grains already fading are skipped
+int GrainSpawner::findVictim(const GrainPool& pool) const noexcept
+{
+    int   victim = -1;
+    float best = 0.0f;
+
+    switch (overflowPolicy)
+    {
+    case OverflowPolicy::StealQuietest:
+        for (int i = 0; i < pool.numActive; ++i)
         {
-            const int delay = static_cast<int>(cursor);
+            const uint16_t g = pool.activeList[i];
+            if (pool.fading[g]) continue;
+
+            const float loudness = pool.gain[g] * grain::env::level(pool, g);
+            if (victim < 0 || loudness < best)
+            {
+                victim = g;
+                best = loudness;
+            }
+        }
+        return victim;
 
-            // Pick a free slot (drop if pool is full)
-            const int index = findFreeGrainIndex(pool);
-            if (index >= 0)
-                spawnGrain(index, pool, currentSampleOffset + delay, v);   // sample-accurate start
-            // else { /* overflow → graceful drop */ }
+    case OverflowPolicy::StealBusiestVoice:
+    {
+        int count[VoicePool::kMaxVoices] = {};
+        int busiest = -1;
+        for (int i = 0; i < pool.numActive; ++i)
+        {
+            const uint16_t g = pool.activeList[i];
+            if (pool.fading[g]) continue;
 
-			cursor += grainsPerSec;   // next grain in this voice
+            const int v = pool.voiceIdx[g];
+            if (++count[v] > (busiest < 0 ? 0 : count[busiest]))
+                busiest = v;
         }
 
-        voices.spawnCursor[v] = cursor - numSamples;     // spill-over into next block
+        uint64_t oldest = UINT64_MAX;
+        for (int i = 0; busiest >= 0 && i < pool.numActive; ++i)
+        {
+            const uint16_t g = pool.activeList[i];
+            if (!pool.fading[g] && pool.voiceIdx[g] == busiest && pool.startAt[g] < oldest)
+            {
+                victim = g;
+                oldest = pool.startAt[g];
+            }
+        }
+        return victim;
+    }
+
+    default: /* StealOldest */
+    {
+        uint64_t oldest = UINT64_MAX;
+        for (int i = 0; i < pool.numActive; ++i)
+        {
+            const uint16_t g = pool.activeList[i];
+            if (!pool.fading[g] && pool.startAt[g] < oldest)
+            {
+                victim = g;
+                oldest = pool.startAt[g];
+            }
+        }
+        return victim;
+    }
     }
 }
 
@@ -131,13 +338,21 @@ void GrainSpawner::advanceTime(int numSamples, GrainPool& pool)
 // MIDI helpers – start/stop one VoiceSpawner
 void GrainSpawner::handleNoteOn(int note)
 {
-	voices.attackSamples[note] = static_cast<int>(voiceSnapShot.envAttack * sampleRate + 0.5);
-	voices.decaySamples[note] = static_cast<int>(voiceSnapShot.envDecay * sampleRate + 0.5);
-	voices.releaseSamples[note] = static_cast<int>(voiceSnapShot.envRelease * sampleRate + 0.5);
-	voices.sustainLevel[note] = voiceSnapShot.sustainLevel;
-	voices.attackPower[note] = voiceSnapShot.envAttackCurve;
-	voices.decayPower[note] = voiceSnapShot.envDecayCurve;
-	voices.releasePower[note] = voiceSnapShot.envReleaseCurve;
+	// Voice settings as they are at the note's own frame within the block
+	const float t = blockLength > 0 ? float(subBlockStart + currentSampleOffset) / float(blockLength) : 1.0f;
+	const auto at = [&](float VoiceParameterSnapshot::* field)
+	{
+		const float from = voiceBlockStart.*field, to = voiceSnapShot.*field;
+		return from == to ? to : from + t * (to - from);
+	};
+
+	voices.attackSamples[note] = static_cast<int>(at(&VoiceParameterSnapshot::envAttack) * sampleRate + 0.5);
+	voices.decaySamples[note] = static_cast<int>(at(&VoiceParameterSnapshot::envDecay) * sampleRate + 0.5);
+	voices.releaseSamples[note] = static_cast<int>(at(&VoiceParameterSnapshot::envRelease) * sampleRate + 0.5);
+	voices.sustainLevel[note] = at(&VoiceParameterSnapshot::sustainLevel);
+	voices.attackRow[note] = grain::window::rowForCurve(at(&VoiceParameterSnapshot::envAttackCurve));
+	voices.decayRow[note] = grain::window::rowForCurve(at(&VoiceParameterSnapshot::envDecayCurve));
+	voices.releaseRow[note] = grain::window::rowForCurve(at(&VoiceParameterSnapshot::envReleaseCurve));
 
 	voice::env::noteOn(voices, note); // Set voice active
 }
@@ -147,83 +362,194 @@ void GrainSpawner::handleNoteOff(int note)
 	voice::env::noteOff(voices, note); // Set voice inactive
 }
 
-int GrainSpawner::findFreeGrainIndex(const GrainPool& pool) const
+void GrainSpawner::queueGrain(int slot, int voice, int offset) noexcept
 {
-	// TBA::Can this be optimised?
-    for (int i = 0; i < static_cast<int>(GrainPool::kMaxGrains); ++i)
+    queuedSlot[static_cast<std::size_t>(numQueued)] = static_cast<uint16_t>(slot);
+    queuedVoice[static_cast<std::size_t>(numQueued)] = static_cast<uint8_t>(voice);
+    queuedOffset[static_cast<std::size_t>(numQueued)] = offset;
+    ++numQueued;
+}
+
+// ────────────────────────────────────────────────────────────────
+// Phase 2 – initialise every queued grain, field by field
+void GrainSpawner::spawnQueued(GrainPool& pool)
+{
+    TRACE_DSP();
+
+    for (int first = 0; first < numQueued; first += kRandomBatch)
     {
-        if (!pool.active[i])
-            return i;
+        const int n = std::min(kRandomBatch, numQueued - first);
+        rng.fill(randoms.data(), n * kNumRandomFields);    // grain i: counters 5i … 5i + 4
+
+        if (rampsActive) initializeBatch<true>(pool, first, n);
+        else             initializeBatch<false>(pool, first, n);
+
+        for (int i = first; i < first + n; ++i)
+        {
+            const int index = queuedSlot[static_cast<std::size_t>(i)];
+            copyGrainToUI(index, pool);
+            pool.schedule(static_cast<std::size_t>(index), pool.delay[index]);   // joins the active list when due
+        }
     }
 
-    return -1; // No free grain found
+    numQueued = 0;
 }
 
-void GrainSpawner::spawnGrain(int index, GrainPool& pool, int delayOffset, int midiNote)
+// Helper function implementations:
+template <bool Ramped>
+void GrainSpawner::initializeBatch(GrainPool& pool, int first, int n)
 {
-    TRACE_DSP();
-    pool.active.set(index);
-    pool.voiceIdx[index] = static_cast<uint8_t>(midiNote);
-
-    const double hostRate = sampleRate;
-    const double lenSec = snapShot.envAttack + snapShot.envSustainLength + snapShot.envRelease;
-    const int totalHostFrames = static_cast<int>(lenSec * hostRate + 0.5);
-
-    pool.frames[index] = totalHostFrames;
-    pool.length[index] = totalHostFrames;
-
-    initializeGainPan(pool, index);
-    initializeStepSize(pool, index, midiNote);
-    initializeEnvelope(pool, index, hostRate);
-    initializePosition(pool, index);
-    initializeDelay(pool, index, delayOffset, hostRate);
-    
-	copyGrainToUI(index, pool);
+    initializeLength<Ramped>(pool, first, n);
+    initializeGainPan<Ramped>(pool, first, n);
+    initializeStepSize<Ramped>(pool, first, n);
+    initializeEnvelope<Ramped>(pool, first, n);
+    initializePosition<Ramped>(pool, first, n);             // needs the step
+    initializeDelay<Ramped>(pool, first, n);
 }
 
-// Helper function implementations:
-void GrainSpawner::initializeGainPan(GrainPool& pool, int index)
+template <bool Ramped>
+void GrainSpawner::initializeLength(GrainPool& pool, int first, int n)
 {
-    pool.gain[index] = juce::Decibels::decibelsToGain(snapShot.gainMin + rng.nextFloat() * (snapShot.gainMax - snapShot.gainMin) + snapShot.gainMod);
-    pool.pan[index] = snapShot.panMin + rng.nextFloat() * (snapShot.panMax - snapShot.panMin) + snapShot.panMod;
+    const ParamRamp attack = rampOf(&ParameterSnapshot::envAttack);
+    const ParamRamp sustain = rampOf(&ParameterSnapshot::envSustainLength);
+    const ParamRamp release = rampOf(&ParameterSnapshot::envRelease);
+
+    for (int i = first; i < first + n; ++i)
+    {
+        const int    index = queuedSlot[static_cast<std::size_t>(i)];
+        const int    at = subBlockStart + queuedOffset[static_cast<std::size_t>(i)];
+        const double lenSec = attack.at<Ramped>(at) + sustain.at<Ramped>(at) + release.at<Ramped>(at);
+        const int    totalHostFrames = static_cast<int>(lenSec * sampleRate + 0.5);
+
+        pool.voiceIdx[index] = queuedVoice[static_cast<std::size_t>(i)];
+        pool.frames[index] = totalHostFrames;
+        pool.length[index] = totalHostFrames;
+    }
 }
 
-void GrainSpawner::initializeStepSize(GrainPool& pool, int index, int midiNote)
+template <bool Ramped>
+void GrainSpawner::initializeGainPan(GrainPool& pool, int first, int n)
 {
-    double step = sample->sampleRate / sampleRate;
+    const ParamRamp gainMin = rampOf(&ParameterSnapshot::gainMin);
+    const ParamRamp gainMax = rampOf(&ParameterSnapshot::gainMax);
+    const ParamRamp panMin = rampOf(&ParameterSnapshot::panMin);
+    const ParamRamp panMax = rampOf(&ParameterSnapshot::panMax);
 
-    if (snapShot.rootMidi >= 0 && snapShot.rootMidi < 128 && snapShot.rootMidi != midiNote)
-        step *= std::pow(2.0, (midiNote - snapShot.rootMidi) / 12.0);
+    for (int i = first; i < first + n; ++i)
+    {
+        const int   index = queuedSlot[static_cast<std::size_t>(i)];
+        const int   at = subBlockStart + queuedOffset[static_cast<std::size_t>(i)];
+        const float gainLow = gainMin.at<Ramped>(at), panLow = panMin.at<Ramped>(at);
+        pool.gain[index] = grain::ratio::fromDecibels(gainLow + random(i, kRandGain) * (gainMax.at<Ramped>(at) - gainLow) + snapShot.gainMod);
+        pool.pan[index] = panLow + random(i, kRandPan) * (panMax.at<Ramped>(at) - panLow) + snapShot.panMod;
+    }
+}
+
+template <bool Ramped>
+void GrainSpawner::initializeStepSize(GrainPool& pool, int first, int n)
+{
+    const double baseStep = sample->sampleRate / sampleRate;
+    const bool   hasRoot = snapShot.rootMidi >= 0 && snapShot.rootMidi < 128;
+    const ParamRamp pitchMin = rampOf(&ParameterSnapshot::pitchMin);
+    const ParamRamp pitchMax = rampOf(&ParameterSnapshot::pitchMax);
+
+    for (int i = first; i < first + n; ++i)
+    {
+        const int   index = queuedSlot[static_cast<std::size_t>(i)];
+        const int   note = queuedVoice[static_cast<std::size_t>(i)];
+        const int   at = subBlockStart + queuedOffset[static_cast<std::size_t>(i)];
+        const float low = pitchMin.at<Ramped>(at);
+        const float pitch = low + random(i, kRandPitch) * (pitchMax.at<Ramped>(at) - low) + snapShot.pitchMod;
+        const float semitones = float(hasRoot ? note - snapShot.rootMidi : 0) + pitch;
+
+        // 0 semitones gives a ratio of exactly 1, so unity grains keep their unit step
+        pool.step[index] = samplePosition::toFixed(baseStep * double(grain::ratio::fromSemitones(semitones)));
+    }
+}
+
+template <bool Ramped>
+void GrainSpawner::initializeEnvelope(GrainPool& pool, int first, int n)
+{
+    const bool wholeGrain = grain::window::spansWholeGrain(snapShot.envShape);
+    const ParamRamp attack = rampOf(&ParameterSnapshot::envAttack);
+    const ParamRamp release = rampOf(&ParameterSnapshot::envRelease);
+
+    for (int i = first; i < first + n; ++i)
+    {
+        const int index = queuedSlot[static_cast<std::size_t>(i)];
+        const int at = subBlockStart + queuedOffset[static_cast<std::size_t>(i)];
+        if (wholeGrain)
+        {
+            pool.envAttackFrames[index] = pool.length[index] / 2;
+            pool.envReleaseFrames[index] = pool.length[index] - pool.envAttackFrames[index];
+        }
+        else
+        {
+            pool.envAttackFrames[index] = static_cast<int>(attack.at<Ramped>(at) * sampleRate + 0.5);
+            pool.envReleaseFrames[index] = static_cast<int>(release.at<Ramped>(at) * sampleRate + 0.5);
+        }
 
-    float pitch = snapShot.pitchMin + rng.nextFloat() * (snapShot.pitchMax - snapShot.pitchMin) + snapShot.pitchMod;
-    if (pitch != 0.0f)
-        step *= std::pow(2.0, pitch / 12.0);
+        pool.envAttackRow[index] = snapShot.envAttackRow;
+        pool.envReleaseRow[index] = snapShot.envReleaseRow;
 
-    pool.step[index] = static_cast<float>(step);
+        grain::env::start(pool, static_cast<std::size_t>(index));
+    }
 }
 
-void GrainSpawner::initializeEnvelope(GrainPool& pool, int index, double hostRate)
+template <bool Ramped>
+void GrainSpawner::initializePosition(GrainPool& pool, int first, int n)
 {
-    pool.envAttackFrames[index] = static_cast<int>(snapShot.envAttack * hostRate + 0.5);
-    pool.envReleaseFrames[index] = static_cast<int>(snapShot.envRelease * hostRate + 0.5);
-    pool.envAttackCurve[index] = snapShot.envAttackCurve;
-    pool.envReleaseCurve[index] = snapShot.envReleaseCurve;
+    // Leave room for the widest interpolator, so switching quality mid-grain is safe
+    constexpr auto support = grain::kernel::kMaxSupport;
+    const int   numSamples = sample->getNumFrames();
+    const ParamRamp posMin = rampOf(&ParameterSnapshot::posMin);
+    const ParamRamp posMax = rampOf(&ParameterSnapshot::posMax);
+
+    for (int i = first; i < first + n; ++i)
+    {
+        const int   index = queuedSlot[static_cast<std::size_t>(i)];
+        const int   at = subBlockStart + queuedOffset[static_cast<std::size_t>(i)];
+        const float low = posMin.at<Ramped>(at);
+        const float pos = low + random(i, kRandPosition) * (posMax.at<Ramped>(at) - low) + snapShot.posMod;
+        // Step is already set (spawnQueued order), so the head can be snapped to it
+        const samplePosition::Fixed readPos = samplePosition::toFixed(
+            samplePosition::fromPercent(numSamples, pos, support.before, support.after));
+        pool.samplePos[index] = samplePosition::snapToStep(readPos, pool.step[index], numSamples, support.after);
+    }
 }
 
-void GrainSpawner::initializePosition(GrainPool& pool, int index)
+template <bool Ramped>
+void GrainSpawner::initializeDelay(GrainPool& pool, int first, int n)
 {
-    float pos = snapShot.posMin + rng.nextFloat() * (snapShot.posMax - snapShot.posMin) + snapShot.posMod;
-    pool.samplePos[index] = samplePosition::fromPercent(sample->buffer->getNumSamples(), pos);
+    const ParamRamp range = rampOf(&ParameterSnapshot::delayRandomRange);
+
+    for (int i = first; i < first + n; ++i)
+    {
+        const int index = queuedSlot[static_cast<std::size_t>(i)];
+        const int at = subBlockStart + queuedOffset[static_cast<std::size_t>(i)];
+        pool.delay[index] = queuedOffset[static_cast<std::size_t>(i)]
+                          + static_cast<int>((random(i, kRandDelay) * range.at<Ramped>(at)) * sampleRate + 0.5);
+    }
 }
 
-void GrainSpawner::initializeDelay(GrainPool& pool, int index, int delayOffset, double hostRate)
+// A parameter from the start of the block to its end; slope 0 if unchanged
+ParamRamp GrainSpawner::rampOf(float ParameterSnapshot::* field) const noexcept
 {
-    pool.delay[index] = delayOffset + static_cast<int>((rng.nextFloat() * snapShot.delayRandomRange) * hostRate + 0.5);
+    const float from = blockStart.*field, to = snapShot.*field;
+    if (from == to || blockLength <= 0)
+        return { to, 0.f };
+    return { from, (to - from) / float(blockLength) };
 }
 
 
 ParameterSnapshot GrainSpawner::loadSampleSnapShot()
 {
+    const int shapeIndex = static_cast<int>(params->get(ParamID::ID::grainEnvShape));
+    const auto shape = static_cast<grain::window::Shape>(
+        std::clamp(shapeIndex, 0, static_cast<int>(grain::window::Shape::Count) - 1));
+    const float attackCurve = params->get(ParamID::ID::grainEnvAttackCurve);
+    const float releaseCurve = params->get(ParamID::ID::grainEnvReleaseCurve);
+
     return ParameterSnapshot
     {
         .gainMin = params->get(ParamID::ID::grainVolumeMin),
@@ -237,9 +563,13 @@ ParameterSnapshot GrainSpawner::loadSampleSnapShot()
 		.envAttack = params->get(ParamID::ID::grainEnvAttack)/1000,
 		.envRelease = params->get(ParamID::ID::grainEnvRelease)/1000,
 		.envSustainLength = params->get(ParamID::ID::grainEnvSustainLength)/1000,
-		.envAttackCurve = params->get(ParamID::ID::grainEnvAttackCurve),
-		.envReleaseCurve = params->get(ParamID::ID::grainEnvReleaseCurve),
+		.envAttackCurve = attackCurve,
+		.envReleaseCurve = releaseCurve,
+		.envShape = shape,
+		.envAttackRow = grain::window::rowForShape(shape, attackCurve),
+		.envReleaseRow = grain::window::rowForShape(shape, releaseCurve),
 		.delayRandomRange = params->get(ParamID::ID::delayRandomRange)/1000,
+		.grainRate = params->get(ParamID::ID::grainRate),
         .rootMidi = static_cast<int>(params->get(ParamID::ID::midiRootNote))
     };
 }
@@ -263,20 +593,21 @@ VoiceParameterSnapshot GrainSpawner::loadVoiceSnapShot()
 void GrainSpawner::copyGrainToUI(int index, GrainPool& pool)
 {
 	visualData.active[index].store(false, std::memory_order_release);
-	visualData.samplePos[index] = pool.samplePos[index];
+	visualData.samplePos[index] = samplePosition::toDouble(pool.samplePos[index]);
     visualData.startTime[index] = visualData.totalSamplesRendered.load(std::memory_order_relaxed)
-        + static_cast<uint64_t>(pool.delay[index]);
+        + static_cast<uint64_t>(subBlockStart + pool.delay[index]);
 
-	const auto sampleLength = sample->buffer->getNumSamples();
+	const auto sampleLength = sample->getNumFrames();
 	visualData.sampleLength[index] = sampleLength;
 	visualData.length[index] = std::min(
 		pool.length[index],
-		samplePosition::availableOutputFrames(sampleLength, pool.samplePos[index], pool.step[index]));
-	visualData.step[index] = pool.step[index];
+		samplePosition::availableOutputFrames(sampleLength, pool.samplePos[index], pool.step[index],
+			grain::kernel::kMaxSupport.after));
+	visualData.step[index] = static_cast<float>(samplePosition::toDouble(pool.step[index]));
 	visualData.envAttackTime[index] = pool.envAttackFrames[index];
 	visualData.envReleaseTime[index] = pool.envReleaseFrames[index];
-	visualData.envAttackCurve[index] = pool.envAttackCurve[index];
-	visualData.envReleaseCurve[index] = pool.envReleaseCurve[index];
+	visualData.envAttackRow[index] = pool.envAttackRow[index];
+	visualData.envReleaseRow[index] = pool.envReleaseRow[index];
 	visualData.maxGain[index] = pool.gain[index];
 	visualData.active[index].store(true, std::memory_order_release); // Publish grain to this instance's editor
 }
@@ -5,6 +5,11 @@
 #include "VoicePool.h"
 #include "../Extras/LoadedSample.h"
 #include "../UI/GrainVisualData.h"
+#include "GrainWindow.h"
+#include "CounterRng.h"
+#include "SpawnScheduler.h"
+#include <array>
+#include <vector>
 
 /* Helpers ───────────────────────────────────────────────────────────────────────────*/
 struct ParameterSnapshot {
@@ -15,8 +20,13 @@ struct ParameterSnapshot {
     float posMin, posMax, posMod = 0.f;
 	float envAttack, envRelease, envSustainLength = 0.1f; // in seconds
     float envAttackCurve, envReleaseCurve = 1.f;
+    grain::window::Shape envShape = grain::window::Shape::Power;
+    uint16_t envAttackRow, envReleaseRow = 0;       // resolved once per block
     float delayRandomRange = 0.f;
+    float grainRate = 1.f;                          // onsets per second per voice
 	int   rootMidi = -1; // -1 means no root note, otherwise 0-127
+
+    bool operator==(const ParameterSnapshot&) const = default;
 };
 
 struct VoiceParameterSnapshot {
@@ -27,6 +37,34 @@ struct VoiceParameterSnapshot {
 	float sustainLevel = 1.0f; // 0 to 1
 };;
 
+/* One parameter across a block: linear from last block's value to this
+   block's. slope is exactly 0 when the parameter did not move, so at()
+   then returns the snapshot value unchanged. */
+struct ParamRamp {
+    float start = 0.f;
+    float slope = 0.f;                              // per frame
+
+    bool  moving() const noexcept { return slope != 0.f; }
+    float at(int frame) const noexcept { return start + slope * float(frame); }
+
+    template <bool Ramped>
+    float at(int frame) const noexcept
+    {
+        if constexpr (Ramped) return at(frame);
+        else                  return start;
+    }
+};
+
+/* What to do when a grain spawns into a full GrainPool */
+enum class OverflowPolicy : uint8_t
+{
+    DropNewest,        // skip the new grain
+    StealOldest,       // fade out the grain that started first
+    StealQuietest,     // fade out the lowest envelope × gain
+    StealBusiestVoice, // fade out the oldest grain of the voice with the most grains
+    Count
+};
+
 /*───────────────────────────────────────────────────────────────────────────*/
 class GrainSpawner
 {
@@ -34,10 +72,15 @@ public:
     GrainSpawner(VoicePool& vp, GrainVisualData& visualDataToUse)
         : voices(vp), visualData(visualDataToUse) {}
 
-    void prepare(double sampleRate, int maxBlockSize);
+    void prepare(double sampleRate, int maxBlockSize, std::size_t grainCapacity);
     void setParameterBank(const ParameterBank* params) noexcept;
+    void setOverflowPolicy(OverflowPolicy policy) noexcept { overflowPolicy = policy; }
+    void setRandomSeed(uint64_t seed) noexcept;        // 0 = per-instance seed; applied at prepare
+    void setSpawnMode(grain::schedule::Mode mode) noexcept { spawnMode = mode; }
 
-    void processMidi(const juce::MidiBuffer& midi, GrainPool& pool);
+    // Once per host block, then processMidi once per sub-block, in order
+    void beginBlock(int numSamples);
+    void processMidi(const juce::MidiBuffer& midi, GrainPool& pool, int startSample, int numSamples);
 
     void setSample(const LoadedSample* source);
 
@@ -51,6 +94,10 @@ private:
     };
     static constexpr int kNumMidiNotes = 128;
 
+    // Stealing: 1/32 of the pool is kept back for new grains while their victims fade
+    static constexpr int    kStealReserveShift = 5;
+    static constexpr double kStealFadeSeconds = 0.002;
+
     // Core helpers -----------------------------------------------------------
 
     void updateRootGate(bool playRootNow);
@@ -58,28 +105,65 @@ private:
     void handleNoteOn(int midiNote);
     void handleNoteOff(int midiNote);
 
-    int  findFreeGrainIndex(const GrainPool& pool) const;
-    void spawnGrain(int idx, GrainPool& pool, int delay, int midiNote);
-    void initializeGainPan(GrainPool& pool, int index);
-    void initializeStepSize(GrainPool& pool, int index, int midiNote);
-    void initializeEnvelope(GrainPool& pool, int index, double hostRate);
-    void initializePosition(GrainPool& pool, int index);
-    void initializeDelay(GrainPool& pool, int index, int delayOffset, double hostRate);
+    bool queueOnset(GrainPool& pool, int voice, double at);
+    int  acquireGrain(GrainPool& pool);
+    int  findVictim(const GrainPool& pool) const noexcept;
+    // Spawning has two phases: advanceTime() only queues (slot, voice,
+    // offset) requests, spawnQueued() then fills the new grains block-wide,
+    // one field at a time. Each initialize* covers queue entries [first, first + n).
+    void queueGrain(int slot, int voice, int offset) noexcept;
+    // Ramped: some parameter moved this block, so values are taken at each
+    // grain's offset; otherwise every ramp folds to a loop constant.
+    void spawnQueued(GrainPool& pool);
+    template <bool Ramped> void initializeBatch(GrainPool& pool, int first, int n);
+    template <bool Ramped> void initializeLength(GrainPool& pool, int first, int n);
+    template <bool Ramped> void initializeGainPan(GrainPool& pool, int first, int n);
+    template <bool Ramped> void initializeStepSize(GrainPool& pool, int first, int n);
+    template <bool Ramped> void initializeEnvelope(GrainPool& pool, int first, int n);
+    template <bool Ramped> void initializePosition(GrainPool& pool, int first, int n);
+    template <bool Ramped> void initializeDelay(GrainPool& pool, int first, int n);
+
+    // Random draws of one grain, in [0, 1); randoms holds one batch, grain-major
+    enum RandomField { kRandGain, kRandPan, kRandPitch, kRandPosition, kRandDelay, kNumRandomFields };
+    static constexpr int kRandomBatch = 256;             // grains per fill
+    float random(int i, RandomField field) const noexcept
+    {
+        return randoms[static_cast<std::size_t>((i % kRandomBatch) * kNumRandomFields + field)];
+    }
 
     ParameterSnapshot loadSampleSnapShot();
 	VoiceParameterSnapshot loadVoiceSnapShot();
+    ParamRamp rampOf(float ParameterSnapshot::* field) const noexcept;
 
     bool playingRootNote = false;
 
 	// UI helpers -------------------------------------------------------------
 	void copyGrainToUI(int index, GrainPool& pool);
 
-	juce::Random rng; // If other parts need this too move shared instance to the engine
+	grain::rng::CounterRng rng; // If other parts need this too move shared instance to the engine
+	grain::rng::CounterRng onsetRng; // Poisson gaps
+	std::array<float, kRandomBatch * kNumRandomFields> randoms {};
+	uint64_t randomSeed = 0;
+	const uint64_t instanceSeed = static_cast<uint64_t>(juce::Random().nextInt64());
 
     /* State ----------------------------------------------------------------*/
     double        sampleRate = 44100.0;
-    int           maxBlockSize = 0;
-    int           currentSampleOffset = 0;
+    int           maxBlockSize = 0;                       // longest sub-block
+    int           blockLength = 0;                        // host block, frames; ramps span it
+    int           subBlockStart = 0;                      // in the host block
+    int           currentSampleOffset = 0;                // in the sub-block
+    bool          rootMode = false;                       // play mode holds the root note
+
+    // Spawn queue, sized to the pool: every entry already owns a slot
+    std::vector<uint16_t> queuedSlot;
+    std::vector<uint8_t>  queuedVoice;
+    std::vector<int>      queuedOffset;                    // start frame in this block
+    int                   numQueued = 0;
+
+    OverflowPolicy overflowPolicy = OverflowPolicy::DropNewest;
+    grain::schedule::Mode spawnMode = grain::schedule::Mode::Periodic;
+    bool           poolExhausted = false;                 // an acquire failed this block
+    uint64_t       blockDropped = 0, blockStolen = 0;     // published once per block
 
     VoicePool& voices;
     GrainVisualData& visualData;
@@ -87,7 +171,12 @@ private:
     const ParameterBank* params = nullptr;
     const LoadedSample* sample = nullptr;
 
-    //snapshot
+    //snapshot – values at the end of the block; the *Start copies hold the
+    //previous block's, which this block ramps from
 	ParameterSnapshot snapShot;
 	VoiceParameterSnapshot voiceSnapShot;
+	ParameterSnapshot blockStart;
+	VoiceParameterSnapshot voiceBlockStart;
+	bool hasSnapShot = false;                             // false until the first block after prepare
+	bool rampsActive = false;                             // blockStart != snapShot
 };
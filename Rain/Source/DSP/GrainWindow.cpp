@@ -0,0 +1,74 @@
+// GrainWindow.cpp – builds the shared grain envelope tables -----------------
+#include "GrainWindow.h"
+#include <cmath>
+
+namespace grain::window
+{
+    static void buildTables(Tables& t) noexcept
+    {
+        constexpr double pi = 3.14159265358979323846;
+
+        // Gaussian, sigma = 1/3 of the half window, shifted and rescaled so
+        // the truncated edge lands exactly on zero.
+        constexpr double sigma = 1.0 / 3.0;
+        const double     edge  = std::exp(-0.5 / (sigma * sigma));
+
+        for (int c = 0; c < kNumCurves; ++c)
+        {
+            const double norm = double(c) / double(kNumCurves - 1);
+            t.curveAxis[c] = float(kMinCurve * std::pow(double(kMaxCurve / kMinCurve), norm));
+        }
+
+        for (int i = 0; i <= kTableSize; ++i)
+        {
+            const double x = double(i) / double(kTableSize);
+
+            for (int c = 0; c < kNumCurves; ++c)
+                t.ramp[c][i] = float(std::pow(x, double(t.curveAxis[c])));
+
+            const double d = (1.0 - x) / sigma;
+            t.ramp[kCosineRow][i]   = float(0.5 - 0.5 * std::cos(pi * x));
+            t.ramp[kGaussianRow][i] = float((std::exp(-0.5 * d * d) - edge) / (1.0 - edge));
+            t.ramp[kLinearRow][i]   = float(x);
+        }
+    }
+
+    const Tables& getTables() noexcept
+    {
+        static const Tables tables = []
+            {
+                Tables t{};
+                buildTables(t);
+                return t;
+            }();
+        return tables;
+    }
+
+    uint16_t rowForCurve(float curve) noexcept
+    {
+        const auto& axis = getTables().curveAxis;
+
+        // Nearest row in log space: compare against the geometric midpoint,
+        // which needs no log on the audio thread.
+        int lo = 0, hi = kNumCurves - 1;
+        while (hi - lo > 1)
+        {
+            const int mid = (lo + hi) / 2;
+            (axis[mid] <= curve ? lo : hi) = mid;
+        }
+
+        return static_cast<uint16_t>(curve * curve < axis[lo] * axis[hi] ? lo : hi);
+    }
+
+    uint16_t rowForShape(Shape shape, float curve) noexcept
+    {
+        switch (shape)
+        {
+        case Shape::Hann:
+        case Shape::Tukey:     return kCosineRow;
+        case Shape::Gaussian:  return kGaussianRow;
+        case Shape::Trapezoid: return kLinearRow;
+        default:               return rowForCurve(curve);
+        }
+    }
+}
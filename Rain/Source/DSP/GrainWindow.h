@@ -0,0 +1,84 @@
+/*==============================================================================
+   GrainWindow.h  – precomputed grain envelope ramps
+
+   Every grain envelope is attack ramp → flat sustain → release ramp. Both
+   ramps are read from one shared set of rising 0 → 1 tables:
+
+     attack  : ramp[attackRow ](t)         t = elapsed / attackFrames
+     release : ramp[releaseRow](u)         u = framesLeft / releaseFrames
+
+   Rows [0, kNumCurves) hold t^curve for log-spaced curves over the whole
+   grainEnvAttackCurve / grainEnvReleaseCurve range, so a curve change only
+   picks another row. The remaining rows hold the classic window shapes.
+   Tables are built once, off the audio thread; the audio thread only
+   looks up and interpolates.
+==============================================================================*/
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+namespace grain::window
+{
+    enum class Shape : uint8_t
+    {
+        Power,       // t^curve ramps over attack / release (classic Rain shape)
+        Hann,        // raised cosine over the whole grain
+        Tukey,       // raised-cosine ramps, flat sustain
+        Gaussian,    // truncated Gaussian over the whole grain
+        Trapezoid,   // linear ramps, flat sustain
+        Count
+    };
+
+    inline constexpr int   kTableSize = 256;       // intervals per ramp
+    inline constexpr int   kNumCurves = 128;       // power-curve rows
+    inline constexpr float kMinCurve  = 0.1f;      // matches the parameter ranges
+    inline constexpr float kMaxCurve  = 10.0f;
+
+    enum ShapeRow : int
+    {
+        kCosineRow = kNumCurves,                   // Hann, Tukey
+        kGaussianRow,
+        kLinearRow,                                // Trapezoid
+        kNumRows
+    };
+
+    struct Tables
+    {
+        float curveAxis[kNumCurves];                         // curve of each power row
+        alignas(64) float ramp[kNumRows][kTableSize + 1];    // rising 0 → 1
+    };
+
+    /* Built on first call (thread-safe static). GrainEngine touches it
+       from its constructor so the audio thread never pays for the build. */
+    const Tables& getTables() noexcept;
+
+    uint16_t rowForCurve(float curve) noexcept;              // nearest power row
+    uint16_t rowForShape(Shape shape, float curve) noexcept; // curve only used by Power
+
+    /* Hann and Gaussian span the whole grain: attack = release = length / 2 */
+    inline bool spansWholeGrain(Shape shape) noexcept
+    {
+        return shape == Shape::Hann || shape == Shape::Gaussian;
+    }
+
+    inline float lookup(const float* row, float t) noexcept
+    {
+        const float pos  = std::clamp(t, 0.0f, 1.0f) * kTableSize;
+        const int   i    = std::min(int(pos), kTableSize - 1);
+        const float frac = pos - float(i);
+        return row[i] + frac * (row[i + 1] - row[i]);
+    }
+
+    /* out[s] = row(pos + s * inc), pos / inc in table units. Branch-free
+       so the compiler can vectorise it. */
+    inline void fillRamp(const float* row, float pos, float inc, float* out, int n) noexcept
+    {
+        for (int s = 0; s < n; ++s)
+        {
+            const float p    = std::clamp(pos + float(s) * inc, 0.0f, float(kTableSize));
+            const int   i    = std::min(int(p), kTableSize - 1);
+            const float frac = p - float(i);
+            out[s] = row[i] + frac * (row[i + 1] - row[i]);
+        }
+    }
+}
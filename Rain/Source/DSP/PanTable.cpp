@@ -0,0 +1,20 @@
+// PanTable.cpp – builds the shared constant-power pan table -------------------
+#include "PanTable.h"
+#include <cmath>
+
+namespace grain::pan
+{
+    const Tables& getTables() noexcept
+    {
+        static const Tables tables = []
+            {
+                constexpr double halfPi = 1.57079632679489661923;
+
+                Tables t{};
+                for (int i = 0; i <= kSteps; ++i)
+                    t.quarterSine[i] = float(std::sin(double(i) / double(kSteps) * halfPi));
+                return t;
+            }();
+        return tables;
+    }
+}
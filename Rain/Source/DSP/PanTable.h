@@ -0,0 +1,41 @@
+/*==============================================================================
+   PanTable.h  – constant-power pan gains without sin/cos
+
+   pan ∈ [-1, 1] → θ = (pan + 1) · π/4,   left = cos θ,   right = sin θ
+
+   left² + right² = 1 across the whole range, so a grain keeps its power as
+   it moves across the field (-3 dB per side at the centre). One quarter
+   sine at kSteps points serves both sides: right reads it forward, left
+   backward. Linear interpolation keeps the error below 2e-6.
+
+   The table is built once, off the audio thread (GrainEngine warms it up).
+==============================================================================*/
+#pragma once
+#include <algorithm>
+
+namespace grain::pan
+{
+    inline constexpr int kSteps = 256;
+
+    struct Tables
+    {
+        alignas(64) float quarterSine[kSteps + 1];             // sin(i / kSteps · π/2)
+    };
+
+    const Tables& getTables() noexcept;
+
+    struct Gains { float left, right; };
+
+    inline Gains constantPower(float pan) noexcept
+    {
+        const auto& t = getTables();
+
+        const float pos  = (std::clamp(pan, -1.0f, 1.0f) + 1.0f) * (0.5f * float(kSteps));
+        const int   i    = std::min(int(pos), kSteps - 1);     // pos ≥ 0: truncation is floor
+        const float frac = pos - float(i);
+        const int   j    = kSteps - i;                          // mirrored index for cos
+
+        return { t.quarterSine[j] + frac * (t.quarterSine[j - 1] - t.quarterSine[j]),
+                 t.quarterSine[i] + frac * (t.quarterSine[i + 1] - t.quarterSine[i]) };
+    }
+}
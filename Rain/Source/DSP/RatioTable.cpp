@@ -0,0 +1,19 @@
+// RatioTable.cpp – builds the shared semitone ratio tables --------------------
+#include "RatioTable.h"
+
+namespace grain::ratio
+{
+    const Tables& getTables() noexcept
+    {
+        static const Tables tables = []
+            {
+                Tables t{};
+                for (int i = 0; i <= kStepsPerOctave; ++i)
+                    t.fine[i] = float(std::exp2(double(i) / double(kStepsPerOctave)));
+                for (int k = 0; k <= 2 * kMaxOctaves; ++k)
+                    t.octave[k] = float(std::exp2(double(k - kMaxOctaves)));
+                return t;
+            }();
+        return tables;
+    }
+}
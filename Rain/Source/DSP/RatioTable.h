@@ -0,0 +1,51 @@
+/*==============================================================================
+   RatioTable.h  – semitones / decibels → linear ratio without pow()
+
+   ratio(s) = 2^(s / 12) = octave[s div 12] · fine[s mod 12]
+
+   `fine` holds one octave at 1/64-semitone steps and is interpolated
+   linearly (relative error below 1e-7, far under a thousandth of a cent);
+   `octave` holds the exact powers of two. Decibels go through the same
+   table: 10^(dB / 20) = 2^(dB · log2(10) / 20).
+
+   Tables are built once, off the audio thread (GrainEngine warms them up).
+==============================================================================*/
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+namespace grain::ratio
+{
+    inline constexpr int   kStepsPerSemitone = 64;
+    inline constexpr int   kStepsPerOctave = 12 * kStepsPerSemitone;
+    inline constexpr int   kMaxOctaves = 16;                   // ±192 semitones, ±96 dB
+    inline constexpr float kSemitonesPerDecibel = 1.99315685693241741f;   // 12 · log2(10) / 20
+    inline constexpr float kMinusInfinityDb = -100.0f;         // as juce::Decibels
+
+    struct Tables
+    {
+        alignas(64) float fine[kStepsPerOctave + 1];           // 2^(i / kStepsPerOctave)
+        float octave[2 * kMaxOctaves + 1];                     // 2^(k - kMaxOctaves)
+    };
+
+    const Tables& getTables() noexcept;
+
+    inline float fromSemitones(float semitones) noexcept
+    {
+        const auto& t = getTables();
+        constexpr float lim = float(12 * kMaxOctaves) - 0.001f;
+
+        const float pos  = (std::clamp(semitones, -lim, lim) + float(12 * kMaxOctaves)) * float(kStepsPerSemitone);
+        const int   i    = int(pos);                           // pos ≥ 0: truncation is floor
+        const float frac = pos - float(i);
+        const int   oct  = i / kStepsPerOctave;
+        const int   j    = i - oct * kStepsPerOctave;
+
+        return t.octave[oct] * (t.fine[j] + frac * (t.fine[j + 1] - t.fine[j]));
+    }
+
+    inline float fromDecibels(float dB) noexcept
+    {
+        return dB > kMinusInfinityDb ? fromSemitones(dB * kSemitonesPerDecibel) : 0.0f;
+    }
+}
@@ -0,0 +1,140 @@
+// RenderWorkers.cpp – helper-thread pool ------------------------------------
+#include "RenderWorkers.h"
+#include "GrainRenderKernel.h"
+
+#if RAIN_KERNEL_X86
+ #include <immintrin.h>
+#endif
+
+static inline void cpuRelax() noexcept
+{
+#if RAIN_KERNEL_X86
+    _mm_pause();
+#elif RAIN_KERNEL_NEON
+    asm volatile("yield");
+#endif
+}
+
+// About 20 - 100 µs of pauses: long enough to catch the next sub-block of
+// the same callback without a wake-up, short enough not to burn a core
+// between callbacks
+static constexpr int kSpinBeforeSleep = 2000;
+
+void RenderWorkers::start(int numHelperThreads)
+{
+    stop();
+
+    quit.store(false);
+    for (int i = 0; i < numHelperThreads; ++i)
+    {
+        // A helper the scheduler may preempt would stall the audio thread,
+        // which waits for every claimed task: without real-time priority
+        // (e.g. Linux without rtprio) it is not used, and blocks it would
+        // have shared run serially
+        auto helper = std::make_unique<Helper>(*this);
+        if (!helper->startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(10)))
+        {
+            DBG("RenderWorkers: no real-time priority, " << i << " of "
+                << numHelperThreads << " render helpers started");
+            break;
+        }
+        helpers.push_back(std::move(helper));
+    }
+}
+
+void RenderWorkers::stop()
+{
+    if (helpers.empty())
+        return;
+
+    quit.store(true);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+
+    for (auto& helper : helpers)
+        helper->waitForThreadToExit(-1);
+    helpers.clear();
+}
+
+bool RenderWorkers::runOneTask(uint32_t gen) noexcept
+{
+    uint64_t c = claim.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        if (static_cast<uint32_t>(c >> 32) != gen)
+            return false;                              // a newer run started
+
+        const int task = static_cast<int>(c & 0xffffu);
+        if (task >= static_cast<int>((c >> 16) & 0xffffu))
+            return false;
+
+        if (claim.compare_exchange_weak(c, c + 1, std::memory_order_acquire))
+        {
+            taskFn(taskContext, task);
+            tasksDone.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+void RenderWorkers::helperLoop() noexcept
+{
+    uint32_t seen = 0;
+
+    for (;;)
+    {
+        uint32_t now = generation.load(std::memory_order_acquire);
+        for (int i = 0; now == seen && i < kSpinBeforeSleep; ++i)
+        {
+            cpuRelax();
+            now = generation.load(std::memory_order_acquire);
+        }
+
+        if (now == seen)
+        {
+            // Counted before the wait re-checks the generation, so run()
+            // either sees a sleeper or this wait sees the new generation
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            generation.wait(seen, std::memory_order_seq_cst);
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+        seen = generation.load(std::memory_order_acquire);
+
+        if (quit.load())
+            return;
+
+        while (runOneTask(seen)) {}
+    }
+}
+
+void RenderWorkers::run(TaskFn fn, void* context, int count) noexcept
+{
+    jassert(count <= kMaxTasks);
+
+    if (helpers.empty() || count <= 1)
+    {
+        for (int t = 0; t < count; ++t)
+            fn(context, t);
+        return;
+    }
+
+    // The previous run has fully drained, and a helper only reads these
+    // after a successful claim of this generation, which the store below
+    // publishes
+    const uint32_t gen = generation.load(std::memory_order_relaxed) + 1;
+    taskFn = fn;
+    taskContext = context;
+    tasksDone.store(0, std::memory_order_relaxed);
+    claim.store(uint64_t(gen) << 32 | uint64_t(count) << 16, std::memory_order_release);
+
+    // notify_all is a syscall: only made when a helper is actually asleep
+    generation.store(gen, std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_seq_cst) != 0)
+        generation.notify_all();
+
+    while (runOneTask(gen)) {}                         // audio thread works too
+
+    while (tasksDone.load(std::memory_order_acquire) < count)
+        cpuRelax();
+}
@@ -0,0 +1,72 @@
+/*==============================================================================
+   RenderWorkers.h  – small helper-thread pool for GrainProcessor PASS 1
+
+   run() hands out task indices [0, numTasks) to the helper threads AND the
+   calling (audio) thread, and returns once every task has finished. Tasks
+   are claimed one at a time from a shared counter, so a thread that drew
+   short grains simply takes the next task.
+
+   The claim word holds the run generation, the task count and the next
+   task, so one compare-exchange checks all three: a helper still leaving
+   the previous run can never claim a task of the next one.
+
+   Threads are started / stopped from prepare (never the audio thread).
+   The audio thread spins on the helpers, so only helpers that got
+   real-time priority are kept; where the OS refuses it there are none and
+   run() works alone. Idle helpers spin briefly, then sleep on an atomic
+   wait; run() wakes sleepers (if any), then spins until the last task is
+   done.
+==============================================================================*/
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <juce_core/juce_core.h>
+
+class RenderWorkers
+{
+public:
+    using TaskFn = void (*)(void* context, int task) noexcept;
+
+    RenderWorkers() = default;
+    ~RenderWorkers() { stop(); }
+
+    RenderWorkers(const RenderWorkers&) = delete;
+    RenderWorkers& operator=(const RenderWorkers&) = delete;
+
+    static constexpr int kMaxTasks = 0xffff;           // per run; fits the claim word
+
+    void start(int numHelperThreads);                  // restarts if already running
+    void stop();
+
+    int getNumHelpers() const noexcept { return static_cast<int>(helpers.size()); }
+
+    // Blocks until fn(context, t) ran for every t in [0, numTasks), numTasks <= kMaxTasks
+    void run(TaskFn fn, void* context, int numTasks) noexcept;
+
+private:
+    class Helper : public juce::Thread
+    {
+    public:
+        explicit Helper(RenderWorkers& ownerToUse) : juce::Thread("Rain render helper"), owner(ownerToUse) {}
+        void run() override { owner.helperLoop(); }
+
+    private:
+        RenderWorkers& owner;
+    };
+
+    void helperLoop() noexcept;
+    bool runOneTask(uint32_t gen) noexcept;            // false: nothing left in this run
+
+    std::vector<std::unique_ptr<Helper>> helpers;
+
+    std::atomic<uint32_t> generation{ 0 };             // bumped once per run
+    std::atomic<uint64_t> claim{ 0 };                  // gen << 32 | numTasks << 16 | next task
+    std::atomic<int>      tasksDone{ 0 };
+    std::atomic<int>      sleepers{ 0 };               // helpers inside generation.wait
+    std::atomic<bool>     quit{ false };
+
+    TaskFn taskFn = nullptr;                           // published by the claim store
+    void*  taskContext = nullptr;
+};
@@ -0,0 +1,77 @@
+/*==============================================================================
+   SampleHandoff.h  – LoadedSamples to the audio thread without locks
+
+   publish() (any thread but the audio thread) parks a heap copy of the
+   sample in a one-entry mailbox; take() (audio thread, block start) empties
+   it with one exchange. Whoever gets a non-null pointer out of an exchange
+   owns that entry, so a sample published twice before the audio thread
+   looks simply replaces the first.
+
+   The audio thread never frees an entry: the ones it is done with go on a
+   lock-free stack through retire(), and reclaim() deletes them on another
+   thread. Deleting can drop the last reference to megabytes of frames.
+==============================================================================*/
+#pragma once
+#include <atomic>
+#include <utility>
+#include "../Extras/LoadedSample.h"
+
+class SampleHandoff
+{
+public:
+    struct Entry
+    {
+        LoadedSample sample;
+        Entry*       nextRetired = nullptr;
+    };
+
+    SampleHandoff() = default;
+    SampleHandoff(const SampleHandoff&) = delete;
+    SampleHandoff& operator=(const SampleHandoff&) = delete;
+
+    ~SampleHandoff()
+    {
+        delete pending.exchange(nullptr, std::memory_order_acquire);
+        reclaim();
+    }
+
+    /* Not real-time safe: allocates, and frees what the audio thread retired */
+    void publish(const LoadedSample& sample)
+    {
+        delete pending.exchange(new Entry{ sample }, std::memory_order_acq_rel);
+        reclaim();
+    }
+
+    /* Audio thread: the newest published entry, or null. Owned by the
+       caller until it is passed to retire(). */
+    Entry* take() noexcept
+    {
+        if (pending.load(std::memory_order_relaxed) == nullptr)
+            return nullptr;                           // the common case: no store
+        return pending.exchange(nullptr, std::memory_order_acq_rel);
+    }
+
+    /* Audio thread: hand back an entry that is no longer read. Null is fine. */
+    void retire(Entry* entry) noexcept
+    {
+        if (entry == nullptr)
+            return;
+
+        entry->nextRetired = retired.load(std::memory_order_relaxed);
+        while (!retired.compare_exchange_weak(entry->nextRetired, entry,
+                                              std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /* Not real-time safe: deletes every retired entry */
+    void reclaim()
+    {
+        for (Entry* e = retired.exchange(nullptr, std::memory_order_acquire); e != nullptr;)
+            delete std::exchange(e, e->nextRetired);
+    }
+
+private:
+    std::atomic<Entry*> pending{ nullptr };
+    std::atomic<Entry*> retired{ nullptr };
+};
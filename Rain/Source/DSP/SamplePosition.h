@@ -1,32 +1,78 @@
 #pragma once
 
 #include <algorithm>
-#include <cmath>
+#include <cstdint>
 #include <limits>
 
 namespace samplePosition
 {
-inline double fromPercent(int numSamples, float percent) noexcept
+// Grain read heads and steps are 32.32 fixed point: frame index in the high
+// word, fraction in the low word. Adding steps is exact, so a grain lands on
+// the same frame however its frames are split across blocks.
+using Fixed = uint64_t;
+
+inline constexpr int    kFracBits = 32;
+inline constexpr Fixed  kFracMask = (Fixed(1) << kFracBits) - 1;
+inline constexpr double kOne = 4294967296.0;            // 2^kFracBits
+
+inline Fixed toFixed(double frames) noexcept            // frames ≥ 0
+{
+    return static_cast<Fixed>(frames * kOne + 0.5);
+}
+
+inline double toDouble(Fixed position) noexcept
+{
+    return static_cast<double>(position) / kOne;
+}
+
+inline int wholeFrames(Fixed position) noexcept
 {
-    if (numSamples <= 1)
+    return static_cast<int>(position >> kFracBits);
+}
+
+// Maps 0..100 % onto [supportBefore, numSamples - supportAfter], so an
+// interpolator reading supportBefore / supportAfter neighbours of int(pos)
+// stays inside the buffer.
+inline double fromPercent(int numSamples, float percent,
+                          int supportBefore = 0, int supportAfter = 1) noexcept
+{
+    const int last = numSamples - supportAfter;
+    if (last <= supportBefore)
         return 0.0;
 
     const auto normalised = std::clamp(percent, 0.0f, 100.0f) / 100.0f;
-    return static_cast<double>(numSamples - 1) * normalised;
+    return static_cast<double>(supportBefore) + static_cast<double>(last - supportBefore) * normalised;
+}
+
+// A power-of-two step >= 1 read from a whole multiple of itself stays on
+// whole frames at its pyramid level, where the unit-step copy path runs.
+// Snaps up, unless that would leave [.., numSamples - supportAfter). On
+// fixed point the power-of-two test and the snap are bit masks.
+inline Fixed snapToStep(Fixed readPosition, Fixed step, int numSamples,
+                        int supportAfter = 1) noexcept
+{
+    if (step < kOne || (step & (step - 1)) != 0)
+        return readPosition;
+
+    const Fixed snapped = (readPosition + step - 1) & ~(step - 1);
+    const Fixed end = static_cast<Fixed>(std::max(numSamples - supportAfter, 0)) << kFracBits;
+    return snapped < end ? snapped : readPosition;
 }
 
-inline int availableOutputFrames(int numSamples, double readPosition, double step) noexcept
+// Output frames a grain can render before its read head passes the last
+// frame the interpolator may touch (idx + supportAfter). In integers on the
+// fixed-point head: no rounding at all.
+inline int availableOutputFrames(int numSamples, Fixed readPosition, Fixed step,
+                                 int supportAfter = 1) noexcept
 {
-    if (numSamples <= 1 || step <= 0.0 || !std::isfinite(readPosition) || !std::isfinite(step))
+    if (numSamples <= supportAfter || step == 0)
         return 0;
 
-    // Linear interpolation reads both idx and idx + 1, so readPosition must
-    // remain strictly below the final sample index.
-    const auto remainingSourceSamples = static_cast<double>(numSamples - 1) - readPosition;
-    if (remainingSourceSamples <= 0.0)
+    const Fixed end = static_cast<Fixed>(numSamples - supportAfter) << kFracBits;
+    if (readPosition >= end)
         return 0;
 
-    const auto frames = std::ceil(remainingSourceSamples / step);
-    return static_cast<int>(std::min(frames, static_cast<double>(std::numeric_limits<int>::max())));
+    const Fixed frames = (end - readPosition + step - 1) / step;
+    return static_cast<int>(std::min<Fixed>(frames, static_cast<Fixed>(std::numeric_limits<int>::max())));
 }
 }
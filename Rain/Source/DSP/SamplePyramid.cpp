@@ -0,0 +1,110 @@
+// SamplePyramid.cpp – builds the octave mip levels --------------------------
+#include "SamplePyramid.h"
+
+namespace
+{
+    /* Half-band lowpass, Blackman-windowed, 31 taps. Only the centre and
+       odd offsets are non-zero; tap[j] sits at offsets ±(2j + 1). */
+    constexpr int kHalfBandOdd = 8;
+
+    struct HalfBand
+    {
+        float tap[kHalfBandOdd];
+    };
+
+    HalfBand designHalfBand() noexcept
+    {
+        constexpr double pi   = 3.14159265358979323846;
+        constexpr double half = 2 * kHalfBandOdd;            // window half length
+
+        HalfBand hb{};
+        double   sum = 0.0;
+        double   h[kHalfBandOdd];
+
+        for (int j = 0; j < kHalfBandOdd; ++j)
+        {
+            const double d = 2 * j + 1;
+            const double w = 0.42 + 0.5 * std::cos(pi * d / half) + 0.08 * std::cos(2.0 * pi * d / half);
+            h[j] = std::sin(pi * d / 2.0) / (pi * d) * w;
+            sum += 2.0 * h[j];
+        }
+
+        // centre tap is 0.5; scale the rest so DC gain is exactly 1
+        for (int j = 0; j < kHalfBandOdd; ++j)
+            hb.tap[j] = float(h[j] * 0.5 / sum);
+
+        return hb;
+    }
+
+    /* dst[i] = (x * h)[2i], x treated as zero outside [0, n) */
+    void decimate(const HalfBand& hb, const float* x, int n, float* dst, int outFrames) noexcept
+    {
+        const auto at = [=](int i) { return (i >= 0 && i < n) ? x[i] : 0.0f; };
+        constexpr int reach = 2 * kHalfBandOdd - 1;
+
+        for (int i = 0; i < outFrames; ++i)
+        {
+            const int c = 2 * i;
+            float     acc = 0.5f * x[c];
+
+            if (c >= reach && c + reach < n)
+            {
+                for (int j = 0; j < kHalfBandOdd; ++j)
+                    acc += hb.tap[j] * (x[c - 2 * j - 1] + x[c + 2 * j + 1]);
+            }
+            else
+            {
+                for (int j = 0; j < kHalfBandOdd; ++j)
+                    acc += hb.tap[j] * (at(c - 2 * j - 1) + at(c + 2 * j + 1));
+            }
+
+            dst[i] = acc;
+        }
+    }
+}
+
+std::shared_ptr<const SamplePyramid> SamplePyramid::build(const juce::AudioBuffer<float>& source,
+                                                          bool compact)
+{
+    auto pyramid = std::make_shared<SamplePyramid>();
+    pyramid->levels.reserve(kMaxLevels);
+
+    const HalfBand hb = designHalfBand();
+    const int      numCh = source.getNumChannels();
+
+    const juce::AudioBuffer<float>* prev = &source;
+    int                             prevFrames = source.getNumSamples();
+    int                             prevOffset = 0;           // level 0 has no padding
+
+    for (int level = 1; level < kMaxLevels && prevFrames / 2 >= kMinFrames; ++level)
+    {
+        Level l;
+        l.numFrames = (prevFrames + 1) / 2;
+        l.data.setSize(numCh, l.numFrames + 2 * kPad);
+        l.data.clear();
+
+        for (int ch = 0; ch < numCh; ++ch)
+            decimate(hb, prev->getReadPointer(ch) + prevOffset, prevFrames,
+                     l.data.getWritePointer(ch) + kPad, l.numFrames);
+
+        pyramid->levels.push_back(std::move(l));
+
+        prev       = &pyramid->levels.back().data;            // reserved: never moves
+        prevFrames = pyramid->levels.back().numFrames;
+        prevOffset = kPad;
+    }
+
+    // Every level is decimated from the float one above, so convert last
+    if (compact)
+    {
+        for (auto& l : pyramid->levels)
+        {
+            juce::AudioBuffer<float> frames(l.data.getArrayOfWritePointers(), numCh, kPad, l.numFrames);
+            l.compact = CompactBuffer(frames);
+            l.data.setSize(0, 0);
+        }
+        pyramid->compact = true;
+    }
+
+    return pyramid;
+}
@@ -0,0 +1,72 @@
+/*==============================================================================
+   SamplePyramid.h  – octave mip levels of the loaded sample
+
+   Level L holds the sample half-band filtered and decimated L times, so
+   frame i of level L sits at frame i * 2^L of the original. A grain
+   reading with step s uses the level where s / 2^L is near 1: it keeps
+   linear-interpolation cost and only sees content that level can carry.
+
+   Level 0 is the original buffer and is not stored here. Every stored
+   level has kPad zero frames on both sides, so interpolators may read a
+   few frames past either end without bounds checks.
+
+   A compact pyramid keeps its levels as CompactBuffer (int16) only; it
+   goes with a compact level 0 (LoadedSample::compact).
+
+   Built off the audio thread (see RainAudioProcessor::updatePlaybackSample).
+==============================================================================*/
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "CompactBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+class SamplePyramid
+{
+public:
+    static constexpr int kMaxLevels = 6;            // 0 … 5, down to 1/32 rate
+    static constexpr int kMinFrames = 64;           // stop decimating below this
+    static constexpr int kPad = 4;                  // ≥ widest interpolator support
+
+    static std::shared_ptr<const SamplePyramid> build(const juce::AudioBuffer<float>& source,
+                                                      bool compact = false);
+
+    int  getNumLevels() const noexcept { return 1 + static_cast<int>(levels.size()); }
+    bool isCompact() const noexcept    { return compact; }
+
+    /* level ≥ 1, clamped to the deepest level. Float pyramids only. */
+    const float* getReadPointer(int level, int channel) const noexcept
+    {
+        return levelAt(level).data.getReadPointer(channel) + kPad;
+    }
+
+    /* Compact pyramids only */
+    const CompactBuffer& getCompactLevel(int level) const noexcept
+    {
+        return levelAt(level).compact;
+    }
+
+    /* round(log2(step)): the remaining step stays within [0.71, 1.41) */
+    static int levelForStep(double step) noexcept
+    {
+        return step < 1.41421356 ? 0 : std::ilogb(step * 1.41421356);
+    }
+
+private:
+    struct Level
+    {
+        juce::AudioBuffer<float> data;              // kPad + numFrames + kPad, empty if compact
+        CompactBuffer compact;                      // compact pyramids only
+        int numFrames = 0;
+    };
+
+    const Level& levelAt(int level) const noexcept
+    {
+        return levels[static_cast<std::size_t>(std::min(level, getNumLevels() - 1) - 1)];
+    }
+
+    std::vector<Level> levels;                      // levels 1 … N
+    bool compact = false;
+};
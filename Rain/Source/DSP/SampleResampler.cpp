@@ -0,0 +1,115 @@
+// SampleResampler.cpp – windowed-sinc rate conversion --------------------------
+#include "SampleResampler.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    constexpr int    kZeroCrossings = 32;               // each side of the centre
+    constexpr int    kTableSteps = 512;                 // table points per zero crossing
+    constexpr double kKaiserBeta = 9.0;
+    constexpr double kCutoff = 0.95;                    // of the lower of the two Nyquists
+    constexpr int    kStopCheckFrames = 4096;           // output frames between shouldStop() polls
+
+    double besselI0(double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 64 && term > 1e-12 * sum; ++k)
+        {
+            const double h = x / (2.0 * k);
+            term *= h * h;
+            sum += term;
+        }
+        return sum;
+    }
+
+    /* sinc(u) · kaiser(u / kZeroCrossings) for u = i / kTableSteps, one guard point */
+    std::vector<float> buildKernelTable()
+    {
+        constexpr double pi = 3.14159265358979323846;
+        constexpr int    size = kZeroCrossings * kTableSteps;
+
+        std::vector<float> table(size + 2, 0.0f);
+        const double norm = besselI0(kKaiserBeta);
+
+        for (int i = 0; i <= size; ++i)
+        {
+            const double u = double(i) / kTableSteps;
+            const double r = u / kZeroCrossings;
+            const double w = besselI0(kKaiserBeta * std::sqrt(std::max(0.0, 1.0 - r * r))) / norm;
+            const double s = i == 0 ? 1.0 : std::sin(pi * u) / (pi * u);
+            table[static_cast<std::size_t>(i)] = float(s * w);
+        }
+        return table;
+    }
+}
+
+namespace resampler
+{
+std::shared_ptr<juce::AudioBuffer<float>> convert(const juce::AudioBuffer<float>& source,
+                                                  double fromRate, double toRate,
+                                                  const std::function<bool()>& shouldStop)
+{
+    const int numCh = source.getNumChannels();
+    const int numIn = source.getNumSamples();
+
+    if (numIn == 0 || fromRate <= 0.0 || toRate <= 0.0 || fromRate == toRate)
+        return std::make_shared<juce::AudioBuffer<float>>(source);
+
+    const std::vector<float> table = buildKernelTable();
+
+    const double ratio = fromRate / toRate;                  // input frames per output frame
+    const double fc = kCutoff * std::min(1.0, toRate / fromRate);
+    const double reach = kZeroCrossings / fc;                // kernel half width, input frames
+    const double tableScale = fc * kTableSteps;
+    const int    tableEnd = kZeroCrossings * kTableSteps;
+    const int    numOut = static_cast<int>(std::ceil(numIn / ratio));
+
+    auto result = std::make_shared<juce::AudioBuffer<float>>(numCh, numOut);
+    std::vector<float> coef(static_cast<std::size_t>(2 * std::ceil(reach) + 2));
+
+    for (int j = 0; j < numOut; ++j)
+    {
+        if (j % kStopCheckFrames == 0 && shouldStop && shouldStop())
+            return nullptr;
+
+        const double t = j * ratio;
+        const int    first = static_cast<int>(std::floor(t - reach)) + 1;
+        const int    last = static_cast<int>(std::floor(t + reach));
+
+        // coefficients once per output frame, shared by every channel
+        double sum = 0.0;
+        for (int k = first; k <= last; ++k)
+        {
+            const double u = std::abs(t - k) * tableScale;
+            const int    i = static_cast<int>(u);
+            float        c = 0.0f;
+            if (i < tableEnd)
+            {
+                const float f = float(u - i);
+                c = table[static_cast<std::size_t>(i)]
+                  + f * (table[static_cast<std::size_t>(i) + 1] - table[static_cast<std::size_t>(i)]);
+            }
+            coef[static_cast<std::size_t>(k - first)] = c;
+            sum += c;
+        }
+
+        // normalise to unity DC gain, then drop taps outside the source
+        const float gain = sum != 0.0 ? float(1.0 / sum) : 0.0f;
+        const int   lo = std::max(first, 0);
+        const int   hi = std::min(last, numIn - 1);
+
+        for (int ch = 0; ch < numCh; ++ch)
+        {
+            const float* src = source.getReadPointer(ch);
+            float        acc = 0.0f;
+            for (int k = lo; k <= hi; ++k)
+                acc += coef[static_cast<std::size_t>(k - first)] * src[k];
+            result->getWritePointer(ch)[j] = acc * gain;
+        }
+    }
+
+    return result;
+}
+}
@@ -0,0 +1,24 @@
+/*==============================================================================
+   SampleResampler.h  – offline sample-rate conversion of a loaded sample
+
+   Converts a whole buffer once, off the audio thread, so grains can read
+   it at the host rate: unity-pitch grains then step by exactly one frame.
+
+   Kaiser-windowed sinc, 32 zero crossings each side (about -90 dB stop
+   band). When converting down, the cutoff follows the target Nyquist.
+   The source is treated as zero outside its frames.
+==============================================================================*/
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <functional>
+#include <memory>
+
+namespace resampler
+{
+    // Same channel count; ceil(numSamples * toRate / fromRate) frames.
+    // shouldStop is polled every few thousand output frames; once it
+    // returns true the conversion is abandoned and null returned.
+    std::shared_ptr<juce::AudioBuffer<float>> convert(const juce::AudioBuffer<float>& source,
+                                                      double fromRate, double toRate,
+                                                      const std::function<bool()>& shouldStop = {});
+}
@@ -0,0 +1,54 @@
+/*==============================================================================
+   SoaBlock.h  – one heap block carved into structure-of-arrays fields
+
+   allocate(count, a, b, c …) points every field at its own array of
+   `count` zeroed elements, each starting on a cache line. All fields come
+   from a single allocation, so a pool sized at prepare time costs one
+   new/delete and keeps its arrays next to each other. Element types must
+   be trivially destructible (plain data and std::atomic).
+==============================================================================*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+class SoaBlock
+{
+public:
+    static constexpr std::size_t kAlign = 64;
+
+    /* Not real-time safe: allocates. Invalidates the previous fields. */
+    template <typename... T>
+    void allocate(std::size_t count, T*&... fields)
+    {
+        static_assert((std::is_trivially_destructible_v<T> && ...), "fields are never destroyed");
+
+        bytes = 0;
+        ((bytes += padded(count * sizeof(T))), ...);
+        block = std::make_unique<std::byte[]>(bytes + kAlign);
+
+        std::byte* p = block.get() + (kAlign - reinterpret_cast<std::uintptr_t>(block.get()) % kAlign) % kAlign;
+        ((fields = carve<T>(p, count)), ...);
+    }
+
+    std::size_t getSizeInBytes() const noexcept { return bytes; }
+
+private:
+    static constexpr std::size_t padded(std::size_t n) noexcept
+    {
+        return (n + kAlign - 1) / kAlign * kAlign;
+    }
+
+    template <typename T>
+    static T* carve(std::byte*& p, std::size_t count)
+    {
+        T* field = reinterpret_cast<T*>(p);
+        std::uninitialized_value_construct_n(field, count);
+        p += padded(count * sizeof(T));
+        return field;
+    }
+
+    std::unique_ptr<std::byte[]> block;
+    std::size_t                  bytes = 0;
+};
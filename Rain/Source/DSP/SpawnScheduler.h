@@ -0,0 +1,46 @@
+/*==============================================================================
+   SpawnScheduler.h  – when each voice starts its grains within a block
+
+   Periodic : onsets at cursor, cursor + interval, …  The count for a span
+              is one division, so a block costs O(1) per voice however
+              many of those grains the pool can actually take.
+   Poisson  : exponential gaps with mean `interval` (a stochastic cloud of
+              the same average density). Gaps are memoryless, so onsets
+              the pool cannot take are skipped by restarting the draw at
+              the end of the span, again O(1).
+
+   The cursor is the next onset, in frames from the start of the span;
+   after a span of n frames it carries over as cursor - n.
+==============================================================================*/
+#pragma once
+#include "CounterRng.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace grain::schedule
+{
+    enum class Mode : uint8_t { Periodic, Poisson, Count };
+
+    inline constexpr double kMinInterval = 1.0 / 64.0;    // frames; bounds the onset count
+
+    /* Onsets at cursor + k · interval inside [0, numFrames) */
+    inline int countPeriodic(double cursor, double interval, int numFrames) noexcept
+    {
+        if (cursor >= numFrames)
+            return 0;
+        return static_cast<int>(std::ceil((double(numFrames) - cursor) / interval));
+    }
+
+    /* Next exponential gap, mean `interval` frames; u in [0, 1) */
+    inline double poissonGap(float u, double interval) noexcept
+    {
+        return -std::log1p(-double(u)) * interval;
+    }
+
+    /* Expected number of onsets left in a span of `frames` frames */
+    inline int expectedOnsets(double frames, double interval) noexcept
+    {
+        return frames > 0.0 ? static_cast<int>(frames / interval + 0.5) : 0;
+    }
+}
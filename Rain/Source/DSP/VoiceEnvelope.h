@@ -1,16 +1,11 @@
 ﻿#pragma once
 #include "VoicePool.h"
-#include <cmath>
+#include "GrainWindow.h"
 #include <limits>
 #include <algorithm>
 
 namespace voice::env
 {
-    inline float powCurve(float x, float power) noexcept
-    {
-        return std::pow(std::clamp(x, 0.0f, 1.0f), power);
-    }
-
     /*--------------------------------------------------------------------
         VoicePool::setStage  – initialise a voice stage
     --------------------------------------------------------------------*/
@@ -48,80 +43,201 @@ namespace voice::env
     }
 
     /*--------------------------------------------------------------------
-        Advance every active voice envelope by ONE sample
+        Voice → render bus bookkeeping
     --------------------------------------------------------------------*/
-    inline void updateOneSample(VoicePool& vp) noexcept
+    inline void releaseBus(VoicePool& vp, std::size_t v) noexcept
+    {
+        if (vp.bus[v] < 0)
+            return;
+
+        vp.freeBuses[vp.numFreeBuses++] = static_cast<uint8_t>(vp.bus[v]);
+        vp.bus[v] = -1;
+    }
+
+    /* Voice finished sounding: stop it and hand its bus back */
+    inline void retire(VoicePool& vp, std::size_t v) noexcept
+    {
+        vp.active.reset(v);
+        vp.stage[v] = Stage::Idle;
+        releaseBus(vp, v);
+    }
+
+    /* Quietest voice holding a bus in its release tail, with more than
+       minFramesLeft to go; kMaxVoices if there is none */
+    inline std::size_t quietestTail(const VoicePool& vp, int minFramesLeft) noexcept
+    {
+        std::size_t best = VoicePool::kMaxVoices;
+        for (std::size_t v = 0; v < VoicePool::kMaxVoices; ++v)
+            if (vp.active.test(v) && vp.bus[v] >= 0 && vp.stage[v] == Stage::Release
+                && vp.stageSamplesLeft[v] > minFramesLeft
+                && (best == VoicePool::kMaxVoices || vp.level[v] < vp.level[best]))
+                best = v;
+        return best;
+    }
+
+    /* Oldest voice holding a bus; only asked when no release tail has one */
+    inline std::size_t oldestVoice(const VoicePool& vp) noexcept
+    {
+        std::size_t best = VoicePool::kMaxVoices;
+        for (std::size_t v = 0; v < VoicePool::kMaxVoices; ++v)
+            if (vp.active.test(v) && vp.bus[v] >= 0
+                && (best == VoicePool::kMaxVoices
+                    || vp.numOnsets - vp.onsetOrder[v] > vp.numOnsets - vp.onsetOrder[best]))
+                best = v;
+        return best;
+    }
+
+    /* A note-on always gets a bus. The pool is sized for the polyphony in
+       use, not the note range: when it is empty the quietest release tail
+       gives its bus up on the spot, or failing that the oldest held voice
+       (every bus then belongs to a held note). Usually it never gets that
+       far: while the pool runs low, each note-on fades out the quietest
+       tail over kStealFadeFrames, so its bus is free again by the time
+       one is needed. */
+    inline void acquireBus(VoicePool& vp, std::size_t v) noexcept
+    {
+        if (vp.bus[v] >= 0)
+            return;                                      // retrigger keeps its bus
+
+        if (vp.numFreeBuses == 0)
+        {
+            std::size_t victim = quietestTail(vp, 0);
+            if (victim == VoicePool::kMaxVoices)
+                victim = oldestVoice(vp);
+            retire(vp, victim);                          // its grains go silent
+        }
+
+        vp.bus[v] = static_cast<int8_t>(vp.freeBuses[--vp.numFreeBuses]);
+
+        if (vp.numFreeBuses < VoicePool::kStealHeadroom)
+            if (const std::size_t tail = quietestTail(vp, VoicePool::kStealFadeFrames);
+                tail != VoicePool::kMaxVoices)
+            {
+                vp.releaseSamples[tail] = VoicePool::kStealFadeFrames;
+                setStage(vp, tail, Stage::Release);      // from its current level
+            }
+    }
+
+    /*--------------------------------------------------------------------
+        Advance every active voice envelope across a whole block
+
+        Writes the per-sample level of voice v to
+            gainRamps[bus[v] * stride + s]      s ∈ [0, numSamples)
+
+        Stage boundaries come straight from stageSamplesLeft, so each
+        stage is one fillRamp over the table row picked at note-on.
+        Decay and release only fall, so the silence cut-off is checked
+        on a segment's last sample before any scan. A voice that goes
+        idle mid-block gets zeros for the rest of the block.
+    --------------------------------------------------------------------*/
+    inline constexpr float kDecaySilence   = 0.0001f;    // stop silent notes
+    inline constexpr float kReleaseSilence = 0.001f;
+
+    inline int firstBelow(const float* x, int n, float threshold) noexcept
+    {
+        if (n == 0 || x[n - 1] >= threshold)
+            return n;                                    // falling: none below
+
+        int k = 0;
+        while (x[k] >= threshold)
+            ++k;
+        return k;
+    }
+
+    inline void renderBlock(VoicePool& vp, float* gainRamps, int stride, int numSamples) noexcept
     {
         /* Quick early-out: nothing sounding, nothing to do */
         if (!vp.active.any())
             return;
 
+        const auto&     tables = grain::window::getTables();
+        constexpr float T = float(grain::window::kTableSize);
+
         for (std::size_t v = 0; v < VoicePool::kMaxVoices; ++v)
         {
-            if (!vp.active.test(v))
+            if (!vp.active.test(v) || vp.bus[v] < 0)
                 continue;
 
-            /* -------- per-voice state snapshot ----------------------------------- */
-            int   samplesLeft = --vp.stageSamplesLeft[v];   // pre-decrement
-            float progStep = vp.levelStep[v];            // 1 / stageLen
-            float level = vp.level[v];
+            float* out = gainRamps + static_cast<std::size_t>(vp.bus[v]) * stride;
 
-            /* ---------- stage integrator ----------------------------------------- */
-            switch (vp.stage[v])
+            for (int done = 0; done < numSamples;)
             {
-                case Stage::Attack: {
-                    const float p = 1.0f - samplesLeft * progStep;           // 0→1
-                    level = powCurve(p, vp.attackPower[v]);
-                    if (samplesLeft == 0)
-                        setStage(vp, v, Stage::Decay);
+                const Stage st       = vp.stage[v];
+                const int   left     = vp.stageSamplesLeft[v];
+                const float progStep = vp.levelStep[v];          // 1 / stageLen
+                const int   n = (st == Stage::Sustain) ? numSamples - done
+                                                       : std::min(numSamples - done, left);
+                float*      seg = out + done;
+                int         stopAt = n;                          // sample the voice goes idle
+
+                switch (st)
+                {
+                case Stage::Attack:                              // p : 1/len → 1
+                    grain::window::fillRamp(tables.ramp[vp.attackRow[v]],
+                                            (1.0f - float(left - 1) * progStep) * T,
+                                            progStep * T, seg, n);
                     break;
-                }
 
-                case Stage::Decay:
+                case Stage::Decay:                               // 1 → sustainLevel
                 {
-                    const float p = 1.0f - samplesLeft * progStep;   // 0 → 1 through decay
-                    const float k = powCurve(1.0f - p, vp.decayPower[v]);
+                    grain::window::fillRamp(tables.ramp[vp.decayRow[v]],
+                                            float(left - 1) * progStep * T,
+                                            -progStep * T, seg, n);
+
+                    const float sus = vp.sustainLevel[v];
+                    const float span = 1.0f - sus;
+                    for (int s = 0; s < n; ++s)
+                        seg[s] = sus + span * seg[s];
+
+                    stopAt = firstBelow(seg, n, kDecaySilence);
+                    break;
+                }
 
-                    /* cross-fade from 1.0 down to sustainLevel */
-                    level = vp.sustainLevel[v] + (1.0f - vp.sustainLevel[v]) * k;
+                case Stage::Sustain:
+                    std::fill_n(seg, n, vp.sustainLevel[v]);
+                    break;
 
-                    if (samplesLeft == 0)
-                        setStage(vp, v, Stage::Sustain);
+                case Stage::Release:                             // releaseStart → 0
+                {
+                    grain::window::fillRamp(tables.ramp[vp.releaseRow[v]],
+                                            float(left - 1) * progStep * T,
+                                            -progStep * T, seg, n);
 
-					if (level < 0.0001f)  // stop silent notes
-					{
-						vp.active.reset(v);
-						vp.stage[v] = Stage::Idle;  // no more sound
-						level = 0.0f;               // reset level
-					}
+                    const float from = vp.releaseStart[v];
+                    for (int s = 0; s < n; ++s)
+                        seg[s] *= from;
 
+                    stopAt = firstBelow(seg, n, kReleaseSilence);
+                    if (stopAt == n && n == left)
+                        stopAt = n - 1;                          // release ran out
                     break;
                 }
 
-
-                case Stage::Sustain:
-                    /* nothing to do – level already == sustainLevel */
+                default: /* Idle */
+                    stopAt = 0;
                     break;
+                }
 
-                case Stage::Release: 
+                if (stopAt < n)
                 {
-                    const float p = samplesLeft * progStep;       // 1 → 0  (positive now)
-                    level = vp.releaseStart[v] *                 // fade from stored level
-                        powCurve(p, vp.releasePower[v]);    // curved toward 0
-
-                    if (samplesLeft == 0 || level < 0.001)
-                    {
-                        vp.active.reset(v);
-                        vp.stage[v] = Stage::Idle;
-                    }
+                    std::fill(seg + stopAt, out + numSamples, 0.0f);
+                    vp.level[v] = 0.0f;
+                    retire(vp, v);                               // no more sound
                     break;
                 }
-            }// End of switch
 
-            vp.level[v] = level;
-		}
-		/* --------- end of per-voice loop --------------------------------------- */
-	}
+                vp.level[v] = seg[n - 1];
+                done += n;
+
+                if (st != Stage::Sustain)
+                {
+                    vp.stageSamplesLeft[v] = left - n;
+                    if (left == n)
+                        setStage(vp, v, static_cast<Stage>(static_cast<uint8_t>(st) + 1));
+                }
+            }
+        }
+    }
 
 
     /*--------------------------------------------------------------------
@@ -129,6 +245,9 @@ namespace voice::env
     --------------------------------------------------------------------*/
     inline void noteOn(VoicePool& vp, std::size_t v) noexcept
     {
+        acquireBus(vp, v);
+        vp.onsetOrder[v] = vp.numOnsets++;
+
         vp.active.set(v);
         setStage(vp, v, Stage::Attack);
     }
@@ -3,14 +3,27 @@
 #include <cmath>
 #include <algorithm>
 #include <cstdint>
+#include <iterator>
 
 enum class Stage : uint8_t { Attack, Decay, Sustain, Release, Idle };
 
 struct VoicePool
 {
     static constexpr std::size_t kMaxVoices = 128;   // one per MIDI note
+    static constexpr int         kMaxBuses = 32;      // sounding voices with a bus, tails included
+    static_assert(kMaxBuses <= 128, "bus indices are stored as int8_t");
+
+    // Below this many free buses each note-on shortens the quietest release
+    // tail to kStealFadeFrames, so buses come back before the pool runs dry
+    static constexpr int kStealHeadroom = 4;
+    static constexpr int kStealFadeFrames = 256;
     std::bitset<kMaxVoices> active;
 
+    /* render buses — one per sounding voice, taken at note-on, returned at idle */
+    alignas(64) int8_t  bus[kMaxVoices]{};           // -1 = no bus
+    uint8_t freeBuses[kMaxBuses]{};                  // stack of free bus indices
+    int     numFreeBuses = 0;
+
     /* dynamic state — changes every sample or block */
     alignas(64) Stage stage[kMaxVoices]{};
     alignas(64) float level[kMaxVoices]{};   // current sample value
@@ -25,10 +38,20 @@ struct VoicePool
     alignas(64) float sustainLevel[kMaxVoices]{};
     alignas(64) int   releaseSamples[kMaxVoices]{};
     alignas(64) float  releaseStart[kMaxVoices]{};   // initial level at note-off
-    alignas(64) float attackPower[kMaxVoices]{};
-    alignas(64) float decayPower[kMaxVoices]{};
-	alignas(64) float releasePower[kMaxVoices]{};
+    alignas(64) uint16_t attackRow[kMaxVoices]{};    // grain::window power rows
+    alignas(64) uint16_t decayRow[kMaxVoices]{};
+	alignas(64) uint16_t releaseRow[kMaxVoices]{};
     alignas(64) int   midiNote[kMaxVoices]{};            // 0-127, convenience
+    alignas(64) uint32_t onsetOrder[kMaxVoices]{};       // note-on count at this note's onset
+    uint32_t numOnsets = 0;
+
+    void clear()
+    {
+        active.reset();
+        std::fill(std::begin(bus), std::end(bus), int8_t(-1));
 
-    void clear() { active.reset(); }
+        numFreeBuses = kMaxBuses;
+        for (int b = 0; b < kMaxBuses; ++b)
+            freeBuses[b] = static_cast<uint8_t>(kMaxBuses - 1 - b);
+    }
 };
@@ -1,10 +1,38 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../DSP/CompactBuffer.h"
+#include "WaveformPeaks.h"
+
+class SamplePyramid;
 
 struct LoadedSample
 {
-    std::shared_ptr<juce::AudioBuffer<float>> buffer;
+    std::shared_ptr<juce::AudioBuffer<float>> buffer; // null once dropped for a compact copy
     double sampleRate = 44100.0; // fallback if unknown
     juce::String sourceFilePath;
+    std::shared_ptr<const SamplePyramid> pyramid; // octave mip levels, null until built
+    std::shared_ptr<const CompactBuffer> compact; // int16 frames; when set, grains read these (buffer may be null)
+    std::shared_ptr<const WaveformPeaks> peaks;   // for the display, kept when buffer is dropped
+
+    int getNumFrames() const noexcept
+    {
+        return compact != nullptr ? compact->getNumSamples() : buffer != nullptr ? buffer->getNumSamples() : 0;
+    }
+
+    int getNumChannels() const noexcept
+    {
+        return compact != nullptr ? compact->getNumChannels() : buffer != nullptr ? buffer->getNumChannels() : 0;
+    }
+
+    bool hasAudio() const noexcept { return getNumFrames() > 0; }
+};
+
+/* Background file load, written by the loader thread and polled by the
+   editor: progress while decoding, and a count of applied samples so the
+   display knows when to fetch the new one. */
+struct SampleLoadStatus
+{
+    std::atomic<float>    progress{ -1.0f };    // 0 … 1 while decoding, -1 when idle
+    std::atomic<uint32_t> generation{ 0 };      // bumped each time a new sample is applied
 };
@@ -0,0 +1,54 @@
+/*==============================================================================
+   WaveformPeaks.h  – min/max of a sample's first channel for the display
+
+   Built once per load from the decoded frames, so the waveform can still
+   be drawn after the float buffer is dropped ("compactSamples"). A few
+   thousand buckets are enough for any editor width.
+==============================================================================*/
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <vector>
+
+class WaveformPeaks
+{
+public:
+    static constexpr int kMaxBuckets = 4096;
+
+    explicit WaveformPeaks(const juce::AudioBuffer<float>& source)
+        : numFrames(source.getNumSamples())
+    {
+        if (numFrames <= 0 || source.getNumChannels() <= 0)
+            return;
+
+        const int    numBuckets = std::min(kMaxBuckets, numFrames);
+        const float* samples = source.getReadPointer(0);
+        mins.resize(static_cast<std::size_t>(numBuckets));
+        maxs.resize(static_cast<std::size_t>(numBuckets));
+
+        for (int b = 0; b < numBuckets; ++b)
+        {
+            const int begin = static_cast<int>(static_cast<int64_t>(numFrames) * b / numBuckets);
+            const int end = static_cast<int>(static_cast<int64_t>(numFrames) * (b + 1) / numBuckets);
+            const auto [lo, hi] = std::minmax_element(samples + begin, samples + end);
+            mins[static_cast<std::size_t>(b)] = *lo;
+            maxs[static_cast<std::size_t>(b)] = *hi;
+        }
+    }
+
+    int getNumFrames() const noexcept  { return numFrames; }
+    int getNumBuckets() const noexcept { return static_cast<int>(mins.size()); }
+
+    /* Extremes over buckets [first, last], clamped to the valid range */
+    std::pair<float, float> getRange(int first, int last) const noexcept
+    {
+        first = std::clamp(first, 0, getNumBuckets() - 1);
+        last = std::clamp(last, first, getNumBuckets() - 1);
+        return { *std::min_element(mins.begin() + first, mins.begin() + last + 1),
+                 *std::max_element(maxs.begin() + first, maxs.begin() + last + 1) };
+    }
+
+private:
+    std::vector<float> mins, maxs;
+    int numFrames = 0;
+};
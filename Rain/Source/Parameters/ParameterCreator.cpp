@@ -81,6 +81,10 @@ AudioProcessorValueTreeState::ParameterLayout ParameterCreator::createLayout()
 		ParameterID{ toChars(ID::grainPositionMax), 1 }, "Position Max",
 		linRange(0.f, 100.f, 0.01f), 0.0f, " %"));
 
+	grainGroup->addChild(std::make_unique<AudioParameterChoice>(
+		ParameterID{ toChars(ID::grainInterpolation), 1 }, "Interpolation",
+		StringArray{ "Linear", "Hermite", "Sinc" }, 0)); // order of grain::kernel::Interp
+
 
 	layout.add(std::move(grainGroup));
 
@@ -109,6 +113,10 @@ AudioProcessorValueTreeState::ParameterLayout ParameterCreator::createLayout()
 		ParameterID{ toChars(ID::grainEnvReleaseCurve), 1 }, "Release Curve",
 		linRange(0.1f, 10.f, 0.01f, 0.25f), 3.0f));
 
+	grainShape->addChild(std::make_unique<AudioParameterChoice>(
+		ParameterID{ toChars(ID::grainEnvShape), 1 }, "Window",
+		StringArray{ "Power", "Hann", "Tukey", "Gaussian", "Trapezoid" }, 0)); // order of grain::window::Shape
+
 	layout.add(std::move(grainShape));
 
 	// ─── Voice group ─────────────────────────────────────────────────────
@@ -157,6 +165,14 @@ ParameterCreator::createNonExposed()
     using Map = std::unordered_map<std::string, std::atomic<float>>;
     Map map;
 	//map.emplace(masterGain, 0.0f);
+	map.emplace("renderThreads", 0.0f); // helper threads for grain rendering, 0 = off
+	map.emplace("compactSamples", 0.0f); // 1 = keep playback samples as int16
+	map.emplace("sourceOrdering", 0.0f); // experimental: 1 = render grains sorted by source position; measure with "RainBench wide"
+	map.emplace("grainCapacity", 4096.0f); // grain pool slots, rounded up to 256 / 1024 / 4096 / 16384
+	map.emplace("spawnMode", 0.0f); // grain onsets: 0 periodic at grainRate, 1 Poisson with grainRate as mean density
+	map.emplace("randomSeed", 0.0f); // grain randomisation seed, a whole number 0 … 2^24 (exact in float), 0 = new per instance
+	map.emplace("overflowPolicy", 0.0f); // full grain pool: 0 drop newest, 1 steal oldest, 2 steal quietest, 3 steal from busiest voice
+	map.emplace("grainSilenceDb", -100.0f); // grains below this gain x voice level are not rendered, -100 = render all (default)
     return map;
 }
 
@@ -24,6 +24,8 @@ namespace ParamID
         grainEnvRelease,
         grainEnvAttackCurve,
         grainEnvReleaseCurve,
+        grainEnvShape,
+        grainInterpolation,
 		voiceAttack,
 		voiceDecay,
 		voiceSustain,
@@ -52,6 +54,8 @@ namespace ParamID
         "grainEnvRelease",
         "grainEnvAttackCurve",
         "grainEnvReleaseCurve",
+        "grainEnvShape",
+        "grainInterpolation",
 		"voiceAttack",
 		"voiceDecay",
 		"voiceSustain",
@@ -14,21 +14,12 @@ RainAudioProcessorEditor::RainAudioProcessorEditor (RainAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p), apvts(p.getParameterManager().getAPVTS())
 {
 	waveformDisplay = std::make_unique<WaveDisplay>(apvts);
-	waveformDisplay->setOnAudioLoaded([this](const LoadedSample& sample)
+	waveformDisplay->setOnFileDropped([this](const juce::File& file)
 		{
-			if (sample.buffer && sample.buffer->getNumSamples() > 0)
-			{
-				DBG("Loaded audio with " << sample.buffer->getNumSamples()
-					<< " samples at " << sample.sampleRate << " Hz");
-
-				audioProcessor.setLoadedSample(sample);
-			}
-			else
-			{
-				DBG("LoadedSample came back empty!");
-			}
+			audioProcessor.loadSampleFile(file);     // decoded in the background
 		});
-	waveformDisplay->setSample(audioProcessor.getLoadedSample());
+	waveformDisplay->watchLoader(audioProcessor.getLoadStatus(),
+		[this] { return audioProcessor.getLoadedSample(); });
 
 	grainVisualizer = std::make_unique<GrainVisualizer>(audioProcessor.getEngine().getGrainVisualData());
 	grainSpawnProperties = std::make_unique<GrainSpawnProperties>(apvts);
@@ -1,24 +1,43 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "../DSP/SampleResampler.h"
 
 namespace
 {
 const juce::Identifier sampleStateType { "SAMPLE" };
 const juce::Identifier sampleFileProperty { "filePath" };
 
-LoadedSample loadSampleFromFile(const juce::File& file)
+constexpr int kLoadChunkFrames = 1 << 16;          // decoded between progress updates
+
+// Decodes in chunks so progress can be shown (when asked for); gives up
+// (empty result) as soon as shouldStop() says the result is no longer wanted.
+template <typename StopFn>
+LoadedSample loadSampleFromFile(const juce::File& file, std::atomic<float>* progress, StopFn shouldStop)
 {
     juce::AudioFormatManager formatManager;
     formatManager.registerBasicFormats();
 
     if (auto reader = std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(file)))
     {
+        const int numFrames = static_cast<int>(reader->lengthInSamples);
         auto buffer = std::make_shared<juce::AudioBuffer<float>>(
-            static_cast<int>(reader->numChannels),
-            static_cast<int>(reader->lengthInSamples));
+            static_cast<int>(reader->numChannels), numFrames);
+
+        for (int start = 0; start < numFrames; start += kLoadChunkFrames)
+        {
+            if (shouldStop())
+                return {};
+
+            const int n = std::min(kLoadChunkFrames, numFrames - start);
+            reader->read(buffer.get(), start, n, start, true, true);
+            if (progress != nullptr)
+                progress->store(static_cast<float>(start + n) / static_cast<float>(numFrames),
+                                std::memory_order_relaxed);
+        }
 
-        reader->read(buffer.get(), 0, static_cast<int>(reader->lengthInSamples), 0, true, true);
-        return { std::move(buffer), reader->sampleRate, file.getFullPathName() };
+        LoadedSample sample{ std::move(buffer), reader->sampleRate, file.getFullPathName() };
+        sample.peaks = std::make_shared<const WaveformPeaks>(*sample.buffer);
+        return sample;
     }
 
     return {};
@@ -40,15 +59,42 @@ RainAudioProcessor::RainAudioProcessor()
     )
 #endif
 {
+    startTimerHz(4);
 }
 
-RainAudioProcessor::~RainAudioProcessor() = default;
+RainAudioProcessor::~RainAudioProcessor()
+{
+    stopTimer();
+}
 
 void RainAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     parameterBank.loadFromManager(parameterManager);
     engine.setParameterBank(&parameterBank);
+    engine.setRenderThreads(static_cast<int>(
+        parameterManager.getInternalFloat("renderThreads")->load(std::memory_order_relaxed)));
+    engine.setSourceOrdering(
+        parameterManager.getInternalFloat("sourceOrdering")->load(std::memory_order_relaxed) > 0.5f);
+    engine.setGrainCapacity(static_cast<int>(
+        parameterManager.getInternalFloat("grainCapacity")->load(std::memory_order_relaxed)));
+    engine.setSpawnMode(static_cast<grain::schedule::Mode>(std::clamp(
+        static_cast<int>(parameterManager.getInternalFloat("spawnMode")->load(std::memory_order_relaxed)),
+        0, static_cast<int>(grain::schedule::Mode::Count) - 1)));
+    engine.setRandomSeed(static_cast<uint64_t>(std::clamp(
+        parameterManager.getInternalFloat("randomSeed")->load(std::memory_order_relaxed),
+        0.0f, 16777216.0f)));                       // 2^24: above it floats skip integers
+    engine.setOverflowPolicy(static_cast<OverflowPolicy>(std::clamp(
+        static_cast<int>(parameterManager.getInternalFloat("overflowPolicy")->load(std::memory_order_relaxed)),
+        0, static_cast<int>(OverflowPolicy::Count) - 1)));
+    engine.setSilenceThreshold(
+        parameterManager.getInternalFloat("grainSilenceDb")->load(std::memory_order_relaxed));
     engine.prepare(sampleRate, samplesPerBlock);
+
+    {
+        const juce::ScopedLock lock(loadedSampleLock);
+        playbackRate = sampleRate;
+    }
+    updatePlaybackSample();
 }
 
 void RainAudioProcessor::releaseResources() {}
@@ -152,9 +198,45 @@ void RainAudioProcessor::changeProgramName(int, const juce::String&) {}
 //==============================================================================
 #pragma region State & Editor
 
-void RainAudioProcessor::setLoadedSample(const LoadedSample& sample)
+void RainAudioProcessor::loadSampleFile(const juce::File& file)
+{
+    loadSampleFile(file, true);
+}
+
+void RainAudioProcessor::loadSampleFile(const juce::File& file, bool notifyHost)
 {
-    applyLoadedSample(sample, true);
+    const uint32_t request = loadRequests.fetch_add(1, std::memory_order_relaxed) + 1;
+    loadStatus.progress.store(0.0f, std::memory_order_relaxed);
+    {
+        const juce::ScopedLock lock(loadedSampleLock);
+        pendingFilePath = file.getFullPathName();
+    }
+
+    sampleWorker.addJob([this, file, request, notifyHost]
+        {
+            const auto superseded = [this, request]
+                {
+                    auto* job = juce::ThreadPoolJob::getCurrentThreadPoolJob();
+                    return loadRequests.load(std::memory_order_relaxed) != request
+                        || (job != nullptr && job->shouldExit());
+                };
+
+            auto sample = loadSampleFromFile(file, &loadStatus.progress, superseded);
+            if (superseded())
+                return;                                 // the newer request owns the status
+
+            if (sample.buffer != nullptr && sample.buffer->getNumSamples() > 0)
+                applyLoadedSample(sample, notifyHost);
+            else
+                DBG("Could not load " << file.getFullPathName());
+
+            {
+                const juce::ScopedLock lock(loadedSampleLock);
+                pendingFilePath.clear();
+            }
+
+            loadStatus.progress.store(-1.0f, std::memory_order_relaxed);
+        });
 }
 
 LoadedSample RainAudioProcessor::getLoadedSample() const
@@ -165,16 +247,147 @@ LoadedSample RainAudioProcessor::getLoadedSample() const
 
 void RainAudioProcessor::applyLoadedSample(const LoadedSample& sample, bool notifyHost)
 {
+    bool needsConversion;
     {
         const juce::ScopedLock lock(loadedSampleLock);
         loadedSample = sample;
+        loadedSerial.fetch_add(1, std::memory_order_relaxed);
+        playbackCache.clear();
+        pendingPlayback = {};
+        needsConversion = playbackRate > 0.0 && sample.sampleRate != playbackRate;
     }
 
-    engine.setLoadedSample(sample);
+    // Grains read the file at its own rate until the host-rate copy is ready.
+    // Without a rate change that copy follows shortly: publishing twice
+    // would only crossfade the same frames into themselves.
+    if (needsConversion)
+        engine.setLoadedSample(sample);
+    loadStatus.generation.fetch_add(1, std::memory_order_release);
 
     if (notifyHost)
+        hostDisplayPending.store(true, std::memory_order_relaxed);
+
+    updatePlaybackSample();
+}
+
+void RainAudioProcessor::updatePlaybackSample()
+{
+    const bool compact = parameterManager.getInternalFloat("compactSamples")
+                             ->load(std::memory_order_relaxed) > 0.5f;
+
+    LoadedSample source, cached;
+    PlaybackKey  key;
+    uint32_t     serial;
+    {
+        const juce::ScopedLock lock(loadedSampleLock);
+        serial = loadedSerial.load(std::memory_order_relaxed);
+        if (serial == 0 || playbackRate <= 0.0)
+            return;                                     // nothing loaded, or not prepared yet
+
+        key = { playbackRate, compact };
+        if (auto it = playbackCache.find(key); it != playbackCache.end())
+            cached = it->second;
+        else if (pendingPlayback == key)
+            return;                                     // already being converted
+        else
+            pendingPlayback = key;
+
+        source = loadedSample;
+    }
+
+    if (cached.hasAudio())
+    {
+        engine.setLoadedSample(cached);
+        return;
+    }
+
+    sampleWorker.addJob([this, source, serial, key]
+        {
+            const auto [rate, compactFrames] = key;
+            // A newer sample, or the pool shutting down, makes this work moot;
+            // long conversions poll it so ~ThreadPool never has to kill them
+            const auto superseded = [this, serial]
+                {
+                    auto* job = juce::ThreadPoolJob::getCurrentThreadPoolJob();
+                    return loadedSerial.load(std::memory_order_relaxed) != serial
+                        || (job != nullptr && job->shouldExit());
+                };
+            const auto abandon = [this, key]
+                {
+                    const juce::ScopedLock lock(loadedSampleLock);
+                    if (pendingPlayback == key)
+                        pendingPlayback = {};
+                };
+
+            LoadedSample playback = source;
+            if (playback.buffer == nullptr)
+            {
+                // The float frames were dropped for a compact copy: decode the file again
+                const auto decoded = loadSampleFromFile(juce::File(source.sourceFilePath), nullptr, superseded);
+                if (decoded.buffer == nullptr)
+                {
+                    if (!superseded())
+                        DBG("Could not reload " << source.sourceFilePath);
+                    return abandon();
+                }
+                playback.buffer = decoded.buffer;
+                playback.sampleRate = decoded.sampleRate;
+            }
+
+            if (playback.sampleRate != rate)
+            {
+                playback.buffer = resampler::convert(*playback.buffer, playback.sampleRate, rate, superseded);
+                if (playback.buffer == nullptr)
+                    return abandon();
+                playback.sampleRate = rate;
+            }
+            playback.pyramid = SamplePyramid::build(*playback.buffer, compactFrames);
+
+            if (compactFrames)
+            {
+                // Only the int16 copy stays resident for playback
+                playback.compact = std::make_shared<const CompactBuffer>(*playback.buffer);
+                playback.buffer = nullptr;
+            }
+
+            applyPlaybackSample(serial, key, playback);
+        });
+}
+
+void RainAudioProcessor::applyPlaybackSample(uint32_t forSerial, PlaybackKey key, const LoadedSample& playback)
+{
+    {
+        const juce::ScopedLock lock(loadedSampleLock);
+        if (loadedSerial.load(std::memory_order_relaxed) != forSerial)
+            return;                                     // another sample was loaded meanwhile
+
+        if (key.second)
+        {
+            // Only the int16 copy plays, so no float frames stay resident: the
+            // display keeps its peaks and a later conversion decodes the file.
+            loadedSample.buffer = nullptr;
+            std::erase_if(playbackCache, [](const auto& entry) { return !entry.first.second; });
+        }
+
+        playbackCache[key] = playback;
+        if (pendingPlayback == key)
+            pendingPlayback = {};
+        if (key.first != playbackRate)
+            return;                                     // host moved on; kept for later
+    }
+
+    engine.setLoadedSample(playback);
+}
+
+// Message thread: host notifications, and freeing the samples the audio
+// thread has switched away from
+void RainAudioProcessor::timerCallback()
+{
+    if (hostDisplayPending.exchange(false, std::memory_order_relaxed))
         updateHostDisplay(juce::AudioProcessorListener::ChangeDetails()
                               .withNonParameterStateChanged(true));
+
+    engine.releaseRetiredSamples();
 }
 
 bool RainAudioProcessor::hasEditor() const
@@ -200,11 +413,16 @@ void RainAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 
     // 3) non-parameter sample state. Keep the file path rather than embedding a
     // potentially very large audio file in the host's plugin state.
-    const auto sample = getLoadedSample();
-    if (sample.sourceFilePath.isNotEmpty())
+    // A file still being decoded is saved in place of the current one.
+    juce::String filePath;
+    {
+        const juce::ScopedLock lock(loadedSampleLock);
+        filePath = pendingFilePath.isNotEmpty() ? pendingFilePath : loadedSample.sourceFilePath;
+    }
+    if (filePath.isNotEmpty())
     {
         juce::ValueTree sampleState(sampleStateType);
-        sampleState.setProperty(sampleFileProperty, sample.sourceFilePath, nullptr);
+        sampleState.setProperty(sampleFileProperty, filePath, nullptr);
         root.addChild(sampleState, -1, nullptr);
     }
 
@@ -231,17 +449,13 @@ void RainAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
     if (auto intern = root.getChildWithName("INTERNALS"); intern.isValid())
         parameterManager.deserialiseInternals(intern);
 
-    // 3) reload the sample before an editor is created, so WaveDisplay can
-    // initialise from the same restored state as the parameter controls.
+    // 3) reload the sample in the background; an open WaveDisplay picks it
+    // up through the load status once it is decoded.
     if (auto sampleState = root.getChildWithName(sampleStateType); sampleState.isValid())
     {
         const juce::File file(sampleState.getProperty(sampleFileProperty).toString());
         if (file.existsAsFile())
-        {
-            auto sample = loadSampleFromFile(file);
-            if (sample.buffer && sample.buffer->getNumSamples() > 0)
-                applyLoadedSample(sample, false);
-        }
+            loadSampleFile(file, false);
     }
 }
 
@@ -6,7 +6,11 @@
 #include "../Parameters/ParameterManager.h"
 #include "../Parameters/ParameterBank.h"
 
-class RainAudioProcessor  : public juce::AudioProcessor
+#include <map>
+#include <utility>
+
+class RainAudioProcessor  : public juce::AudioProcessor,
+                            private juce::Timer
 {
 public:
     //==============================================================================
@@ -49,13 +53,22 @@ public:
 	//==============================================================================
 	GrainEngine& getEngine() { return engine; }
 	ParameterManager& getParameterManager() { return parameterManager; }
-	void setLoadedSample(const LoadedSample& sample);
+	// Decodes on the sample worker and returns at once; progress and the
+	// switch to the new sample show up in getLoadStatus()
+	void loadSampleFile(const juce::File& file);
 	LoadedSample getLoadedSample() const;
+	const SampleLoadStatus& getLoadStatus() const noexcept { return loadStatus; }
 
 private:
+    using PlaybackKey = std::pair<double, bool>;    // host rate, int16 storage
+
 	// ------------------------------------------------------ Functions
     void applyLimiter(juce::AudioBuffer<float>& buffer);
+    void timerCallback() override;
+    void loadSampleFile(const juce::File& file, bool notifyHost);
     void applyLoadedSample(const LoadedSample& sample, bool notifyHost);
+    void updatePlaybackSample();
+    void applyPlaybackSample(uint32_t forSerial, PlaybackKey key, const LoadedSample& playback);
 
     // ------------------------------------------------------ parameters (UI)
     ParameterManager parameterManager{ *this };   // owns the APVTS the host sees
@@ -65,11 +78,29 @@ private:
     GrainEngine      engine;                       // the granular synth core
 
     mutable juce::CriticalSection loadedSampleLock;
-    LoadedSample loadedSample;
+    LoadedSample loadedSample;                     // as loaded from file (editor, state)
+    std::atomic<uint32_t> loadedSerial{ 0 };       // bumped with loadedSample, 0 = none yet
+
+    // What the engine reads: loadedSample converted to a host rate, with its
+    // pyramid, optionally as int16 ("compactSamples"). Keyed by both so a
+    // later prepareToPlay can reuse a conversion.
+    std::map<PlaybackKey, LoadedSample> playbackCache;
+    double      playbackRate = 0.0;                // last prepared host rate, 0 = none yet
+    PlaybackKey pendingPlayback{};                 // conversion queued for this key
+
+    SampleLoadStatus      loadStatus;
+    juce::String          pendingFilePath;         // being decoded; saved in place of loadedSample's
+    std::atomic<uint32_t> loadRequests{ 0 };       // a newer request abandons an older decode
+    std::atomic<bool>     hostDisplayPending{ false };  // told to the host from the message thread
 
 #if PERFETTO
     MelatoninPerfetto tracingSession;
 #endif
 
+    // Converts samples and builds their pyramids off the message and audio
+    // threads. Declared last so it is destroyed (and its jobs finished)
+    // before anything above.
+    juce::ThreadPool sampleWorker{ 1 };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RainAudioProcessor)
 };
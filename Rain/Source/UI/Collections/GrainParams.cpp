@@ -21,6 +21,13 @@ GrainParams::GrainParams(juce::AudioProcessorValueTreeState& apvts)
 	addAndMakeVisible(grainGainSlider);
 	addAndMakeVisible(grainPanSlider);
 
+	// Interpolation quality selector, items mirror the choice parameter
+	if (auto* quality = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(toChars(ID::grainInterpolation))))
+		interpolationBox.addItemList(quality->choices, 1);
+	interpolationAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+		apvts, toChars(ID::grainInterpolation), interpolationBox);
+	addAndMakeVisible(interpolationBox);
+
 	//addAndMakeVisible(grainPitchRandomSlider);
 	//addAndMakeVisible(grainFineRandomSlider);
 	//addAndMakeVisible(grainGainRandomSlider);
@@ -74,5 +81,8 @@ void GrainParams::resized()
 	grainGainSlider.setBounds(12, grainPitchSlider.getBottom(), sliderWidth, sliderHeight);
 	//grainGainRandomSlider.setBounds(grainPitchRandomSlider.getRight(), 26, sliderWidth, sliderHeight);
 	grainPanSlider.setBounds(12, grainGainSlider.getBottom(), sliderWidth, sliderHeight);
+
+	// Interpolation selector sits in the title row, right aligned
+	interpolationBox.setBounds(getWidth() - 12 - 90, 4, 90, 20);
 	//grainPanRandomSlider.setBounds(grainGainRandomSlider.getRight(), 26, sliderWidth, sliderHeight);
 }
@@ -19,6 +19,9 @@ private:
 	ParameterSlider grainGainSlider;
 	ParameterSlider grainPanSlider;
 
+	juce::ComboBox interpolationBox;
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> interpolationAttachment;
+
 	/*
 	ParameterSlider grainPitchRandomSlider;
 	//ParameterSlider grainFineRandomSlider;
@@ -17,6 +17,13 @@ GrainSpawnProperties::GrainSpawnProperties(juce::AudioProcessorValueTreeState& a
 	addAndMakeVisible(releaseSlider);
 	addAndMakeVisible(attackCurveSlider);
 	addAndMakeVisible(releaseCurveSlider);
+
+	// Window shape selector, items mirror the choice parameter
+	if (auto* shape = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(toChars(ID::grainEnvShape))))
+		windowBox.addItemList(shape->choices, 1);
+	windowAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+		apvts, toChars(ID::grainEnvShape), windowBox);
+	addAndMakeVisible(windowBox);
 }
 
 GrainSpawnProperties::~GrainSpawnProperties()
@@ -54,4 +61,7 @@ void GrainSpawnProperties::resized()
 	sustainSlider.setBounds(attackSlider.getRight(), 26, sliderWidth, sliderHeight);
 	releaseSlider.setBounds(sustainSlider.getRight(), 26, sliderWidth, sliderHeight);
 	releaseCurveSlider.setBounds(releaseSlider.getRight(), 26, sliderWidth/2, sliderHeight);
+
+	// Window selector sits in the title row, right aligned
+	windowBox.setBounds(getWidth() - 12 - 110, 4, 110, 20);
 }
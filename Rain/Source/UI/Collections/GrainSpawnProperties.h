@@ -23,6 +23,9 @@ private:
 	ParameterSlider attackCurveSlider;
 	ParameterSlider releaseCurveSlider;
 
+	juce::ComboBox windowBox;
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> windowAttachment;
+
 	//ParameterSlider delayRandomSlider;
 	//ParameterSlider grainRateSlider;
 
@@ -3,34 +3,66 @@
 #include <bitset>
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
 #include "../DSP/GrainPool.h"
+#include "../DSP/SoaBlock.h"
 
 struct GrainVisualData
 {
-	static constexpr std::size_t kMaxGrains = GrainPool::kMaxGrains;
+	GrainVisualData() { allocate(GrainPool::kDefaultCapacity); }
+	GrainVisualData(const GrainVisualData&) = delete;
+	GrainVisualData& operator=(const GrainVisualData&) = delete;
+
+	/* One entry per GrainPool slot. Allocates: call from prepare only. The
+	   editor holds resizeLock while it reads the arrays. */
+	void allocate(std::size_t grainCapacity)
+	{
+		const std::lock_guard lock(resizeLock);
+		if (grainCapacity == capacity)
+			return;
+
+		slotHighWater.store(0, std::memory_order_release);
+		capacity = grainCapacity;
+		storage.allocate(capacity, active, startTime, length, samplePos, sampleLength,
+		                 envAttackTime, envReleaseTime, envAttackRow, envReleaseRow, maxGain, step);
+	}
+
+	std::size_t getCapacity() const noexcept { return capacity; }
 
 	void clear() noexcept
 	{
-		for (auto& grainIsActive : active)
-			grainIsActive.store(false, std::memory_order_relaxed);
+		for (std::size_t i = 0; i < capacity; ++i)
+			active[i].store(false, std::memory_order_relaxed);
 
 		totalSamplesRendered.store(0, std::memory_order_relaxed);
+		slotHighWater.store(0, std::memory_order_relaxed);
+		grainsDropped.store(0, std::memory_order_relaxed);
+		grainsStolen.store(0, std::memory_order_relaxed);
 	}
 
 	alignas(64) std::atomic<uint64_t> totalSamplesRendered { 0 };
-	alignas(64) std::atomic<bool> active[kMaxGrains] = {};
+	std::atomic<int> slotHighWater { 0 }; // slots >= this hold no live grain; bounds the editor's scan
+	std::atomic<uint64_t> grainsDropped { 0 }; // pool full: new grain not played
+	std::atomic<uint64_t> grainsStolen { 0 };  // pool full: a live grain faded out to make room
+	std::mutex resizeLock;                     // allocate() vs the editor's scan, never the audio thread
+
+	std::atomic<bool>* active = nullptr;
+
+	uint64_t* startTime = nullptr; // Number of samples at the start of the grain
+	int* length = nullptr; // samples
 
-	alignas(64) uint64_t startTime[kMaxGrains]; // Number of samples at the start of the grain
-	alignas(64) int length[kMaxGrains]; // samples
+	double* samplePos = nullptr; // initial sample offset in source
+	int* sampleLength = nullptr; // source length for this grain
 
-	alignas(64) double samplePos[kMaxGrains]; // initial sample offset in source
-	alignas(64) int sampleLength[kMaxGrains]; // source length for this grain
+	int* envAttackTime = nullptr; // samples
+	int* envReleaseTime = nullptr; // samples
+	uint16_t* envAttackRow = nullptr; // grain::window table row
+	uint16_t* envReleaseRow = nullptr; // grain::window table row
 
-	alignas(64) int envAttackTime[kMaxGrains]; // samples
-	alignas(64) int envReleaseTime[kMaxGrains]; // samples
-	alignas(64) float envAttackCurve[kMaxGrains]; // Power
-	alignas(64) float envReleaseCurve[kMaxGrains]; // Power
+	float* maxGain = nullptr;
+	float* step = nullptr;     // step size in samples
 
-	alignas(64) float maxGain[kMaxGrains];
-	alignas(64) float step[kMaxGrains];     // step size in samples
+private:
+	std::size_t capacity = 0;
+	SoaBlock storage;
 };
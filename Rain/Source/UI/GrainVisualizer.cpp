@@ -1,5 +1,6 @@
 #include "GrainVisualizer.h"
 #include "WaveformDisplayMetrics.h"
+#include "../DSP/GrainWindow.h"
 
 GrainVisualizer::GrainVisualizer(GrainVisualData& visualDataToUse)
     : visualData(visualDataToUse)
@@ -13,8 +14,17 @@ void GrainVisualizer::paint(juce::Graphics& g)
     TRACE_COMPONENT();
 
 	const uint64_t totalSamplesRendered = visualData.totalSamplesRendered.load(std::memory_order_relaxed);
+	const auto& windows = grain::window::getTables();
 
-    for (size_t i = 0; i < GrainVisualData::kMaxGrains; ++i)
+	// The arrays are reallocated when prepare changes the grain capacity
+	const std::unique_lock resizing(visualData.resizeLock, std::try_to_lock);
+	if (!resizing.owns_lock())
+		return;
+
+	const auto numSlots = std::min(static_cast<size_t>(visualData.slotHighWater.load(std::memory_order_acquire)),
+		visualData.getCapacity());
+
+    for (size_t i = 0; i < numSlots; ++i)
     {
         // Skip inactive grains
         if (!visualData.active[i].load(std::memory_order_acquire))
@@ -62,8 +72,7 @@ void GrainVisualizer::paint(juce::Graphics& g)
         if (timeSinceStart < (uint64_t)attack)
         {
             const float norm = (float)timeSinceStart / (float)attack;            // 0…1
-            const float curve = visualData.envAttackCurve[i];
-            gain = std::pow(norm, curve) * maxGain;
+            gain = grain::window::lookup(windows.ramp[visualData.envAttackRow[i]], norm) * maxGain;
         }
         // ─────────────────────────────────────────────── Sustain
         else if (timeSinceStart < (uint64_t)sustainEnd)
@@ -74,8 +83,7 @@ void GrainVisualizer::paint(juce::Graphics& g)
         else
         {
             const float norm = (float)(timeSinceStart - sustainEnd) / (float)release; // 0…1
-            const float curve = visualData.envReleaseCurve[i];
-            gain = (1.0f - std::pow(norm, curve)) * maxGain;
+            gain = grain::window::lookup(windows.ramp[visualData.envReleaseRow[i]], 1.0f - norm) * maxGain;
         }
 
         // To screenspace
@@ -20,8 +20,10 @@ void WaveDisplay::paint(juce::Graphics& g)
 	g.drawRoundedRectangle(getLocalBounds().toFloat(), 20.0f, 2.0f);
 	g.setFont(20.0f);
 
-    if (auto buf = getCurrentBuffer(); buf && buf->getNumSamples() > 0)
-        drawWaveform(g, *buf);
+    if (shownProgress >= 0.0f)
+        drawProgress(g, shownProgress);
+    else if (auto peaks = getCurrentPeaks(); peaks && peaks->getNumBuckets() > 0)
+        drawWaveform(g, *peaks);
     else
         g.drawFittedText("Drag audio file here", getLocalBounds(),
             juce::Justification::centred, 1);
@@ -42,47 +44,67 @@ void WaveDisplay::filesDropped(const juce::StringArray& files, int, int)
 {
     startPosSlider.setVisible(false);
 
-    if (files.size() == 1 && juce::File(files[0]).existsAsFile())
-        loadFile(juce::File(files[0]));
+    if (files.size() == 1 && juce::File(files[0]).existsAsFile() && onFileDropped)
+        onFileDropped(juce::File(files[0]));
 	else
         repaint();
 }
 
-void WaveDisplay::setOnAudioLoaded(AudioLoadedCallback callback)
+void WaveDisplay::setOnFileDropped(FileDroppedCallback callback)
 {
-    onAudioLoaded = std::move(callback);
+    onFileDropped = std::move(callback);
 }
 
-void WaveDisplay::setSample(const LoadedSample& sample)
+void WaveDisplay::watchLoader(const SampleLoadStatus& status, SampleProvider provider)
 {
-    currentSample = sample;
-    sampleBuffer.store(sample.buffer, std::memory_order_release);
-    startPosSlider.setVisible(sample.buffer != nullptr && sample.buffer->getNumSamples() > 0);
-    repaint();
+    loadStatus = &status;
+    sampleProvider = std::move(provider);
+    shownGeneration = status.generation.load(std::memory_order_acquire);
+    setSample(sampleProvider());                // read after the generation: never older
+    startTimerHz(30);
 }
 
-void WaveDisplay::loadFile(const juce::File& file)
+void WaveDisplay::timerCallback()
 {
-    juce::AudioFormatManager fm;  
-    fm.registerBasicFormats();
+    const uint32_t generation = loadStatus->generation.load(std::memory_order_acquire);
+    if (generation != shownGeneration)
+    {
+        shownGeneration = generation;
+        setSample(sampleProvider());
+    }
 
-    std::unique_ptr<juce::AudioFormatReader> reader(fm.createReaderFor(file));
-    if (reader)
+    const float progress = loadStatus->progress.load(std::memory_order_relaxed);
+    if (progress != shownProgress)
     {
-        auto newBuf = std::make_shared<juce::AudioBuffer<float>>((int)reader->numChannels,
-            (int)reader->lengthInSamples);
-        reader->read(newBuf.get(), 0, (int)reader->lengthInSamples, 0, true, true);
+        shownProgress = progress;
+        repaint();
+    }
+}
+
+void WaveDisplay::setSample(const LoadedSample& sample)
+{
+    samplePeaks.store(sample.peaks, std::memory_order_release);
+    startPosSlider.setVisible(sample.peaks != nullptr && sample.peaks->getNumFrames() > 0);
+    repaint();
+}
 
-        setSample({ newBuf, reader->sampleRate, file.getFullPathName() });
+void WaveDisplay::drawProgress(juce::Graphics& g, float progress)
+{
+    const auto bar = getLocalBounds().toFloat().withSizeKeepingCentre(
+        getWidth() * 0.5f, 12.0f);
 
-        if (onAudioLoaded) onAudioLoaded(currentSample);
-    }
+    g.drawFittedText("Loading " + juce::String(juce::roundToInt(progress * 100.0f)) + " %",
+        getLocalBounds().withBottom(juce::roundToInt(bar.getY()) - 8),
+        juce::Justification::centredBottom, 1);
+
+    g.drawRoundedRectangle(bar, 6.0f, 1.5f);
+    g.fillRoundedRectangle(bar.withWidth(bar.getWidth() * juce::jlimit(0.0f, 1.0f, progress)), 6.0f);
 }
 
 void WaveDisplay::drawWaveform(juce::Graphics& g,
-    const juce::AudioBuffer<float>& buffer)
+    const WaveformPeaks& peaks)
 {
-    const int n = buffer.getNumSamples();
+    const int n = peaks.getNumBuckets();
     if (n <= 0)
         return;
 
@@ -90,21 +112,21 @@ void WaveDisplay::drawWaveform(juce::Graphics& g,
     const int displayWidth = juce::jmax(1, juce::roundToInt(sampleBounds.getWidth()));
     const float top = 24.0f;
     const float bottom = static_cast<float>(getHeight() - 60);
-    const float* samples = buffer.getReadPointer(0);
 
+    // Each pixel column spans the min … max of the buckets under it
     juce::Path path;
-    path.startNewSubPath(sampleBounds.getX(), (top + bottom) * 0.5f);
-
-    for (int pixel = 0; pixel <= displayWidth; ++pixel)
+    for (int pixel = 0; pixel < displayWidth; ++pixel)
     {
-        const float proportion = static_cast<float>(pixel) / static_cast<float>(displayWidth);
-        const int sampleIndex = juce::jlimit(0, n - 1,
-            juce::roundToInt(proportion * static_cast<float>(n - 1)));
-        const float x = sampleBounds.getX() + proportion * sampleBounds.getWidth();
-        const float y = juce::jmap(samples[sampleIndex], -1.0f, 1.0f, bottom, top);
-        path.lineTo(x, y);
+        const int first = pixel * n / displayWidth;
+        const int last = (pixel + 1) * n / displayWidth - 1;
+        const auto [lo, hi] = peaks.getRange(first, last);
+        const float x = sampleBounds.getX() + static_cast<float>(pixel) * sampleBounds.getWidth()
+                                                  / static_cast<float>(displayWidth);
+        const float yTop = juce::jmap(juce::jlimit(-1.0f, 1.0f, hi), -1.0f, 1.0f, bottom, top);
+        const float yBottom = juce::jmap(juce::jlimit(-1.0f, 1.0f, lo), -1.0f, 1.0f, bottom, top);
+        path.addRectangle(x, yTop, 1.0f, juce::jmax(1.0f, yBottom - yTop));
     }
 
     g.setColour(juce::Colours::black);
-    g.strokePath(path, juce::PathStrokeType(1.5f));
+    g.fillPath(path);
 }
@@ -5,10 +5,12 @@
 #include "ParameterSlider.h"
 
 class WaveDisplay : public juce::Component,
-    public juce::FileDragAndDropTarget
+    public juce::FileDragAndDropTarget,
+    private juce::Timer
 {
 public:
-    using AudioLoadedCallback = std::function<void(const LoadedSample&)>;
+    using FileDroppedCallback = std::function<void(const juce::File&)>;
+    using SampleProvider = std::function<LoadedSample()>;
 
     WaveDisplay(juce::AudioProcessorValueTreeState& apvts);
     ~WaveDisplay() override = default;
@@ -20,25 +22,35 @@ public:
     bool isInterestedInFileDrag(const juce::StringArray& files) override;
     void filesDropped(const juce::StringArray& files, int x, int y) override;
 
-    void setOnAudioLoaded(AudioLoadedCallback callback);
+    void setOnFileDropped(FileDroppedCallback callback);
     void setSample(const LoadedSample& sample);
 
+    // Follow a background loader: show the provider's sample now and again
+    // each time the status reports a new one, and draw the decode progress
+    void watchLoader(const SampleLoadStatus& status, SampleProvider provider);
+
 private:
 
-    // 1) Use an atomic to swap the whole pointer instantly & safely.
-    std::atomic<std::shared_ptr<juce::AudioBuffer<float>>> sampleBuffer{ nullptr };
+    // 1) Use an atomic to swap the whole pointer instantly & safely. Only the
+    //    peaks are held, never the frames, so the processor can drop those.
+    std::atomic<std::shared_ptr<const WaveformPeaks>> samplePeaks{ nullptr };
 
     // 2) Helper to grab a snapshot that will stay valid for the whole paint() call.
-    [[nodiscard]] std::shared_ptr<const juce::AudioBuffer<float>> getCurrentBuffer() const noexcept
+    [[nodiscard]] std::shared_ptr<const WaveformPeaks> getCurrentPeaks() const noexcept
     {
-        return sampleBuffer.load(std::memory_order_acquire);
+        return samplePeaks.load(std::memory_order_acquire);
     }
 
-    void loadFile(const juce::File& file);
-    void drawWaveform(juce::Graphics& g, const juce::AudioBuffer<float>& buffer);
+    void timerCallback() override;
+    void drawWaveform(juce::Graphics& g, const WaveformPeaks& peaks);
+    void drawProgress(juce::Graphics& g, float progress);
+
+    FileDroppedCallback onFileDropped;
 
-    LoadedSample currentSample;
-    AudioLoadedCallback onAudioLoaded;
+    const SampleLoadStatus* loadStatus = nullptr;
+    SampleProvider          sampleProvider;
+    uint32_t                shownGeneration = 0;
+    float                   shownProgress = -1.0f;
 
 	ParameterSlider startPosSlider;
 